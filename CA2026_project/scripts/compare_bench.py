@@ -0,0 +1,46 @@
+import json
+import sys
+
+# Compare two bench_results.json files produced by the benchmark driver.
+# Usage: python compare_bench.py <baseline.json> <candidate.json> [threshold]
+# Exits with status 1 if any benchmark got slower by more than threshold (default 10%).
+
+def load(filename):
+    with open(filename, 'r') as f:
+        return {r['name']: r for r in json.load(f)['results']}
+
+def speed(result):
+    # Higher is better for both kinds
+    if result['kind'] == 'workload':
+        return result['cycles_per_sec']
+    return 1.0 / result['ns_per_op'] if result['ns_per_op'] > 0 else 0.0
+
+def compare(baseline_file, candidate_file, threshold):
+    baseline = load(baseline_file)
+    candidate = load(candidate_file)
+    regressions = 0
+
+    print(f"{'benchmark':<30} {'baseline':>14} {'candidate':>14} {'change':>8}")
+    for name, base in baseline.items():
+        if name not in candidate:
+            print(f"{name:<30} {'':>14} {'missing':>14}")
+            continue
+        old, new = speed(base), speed(candidate[name])
+        change = (new - old) / old if old > 0 else 0.0
+        unit = 'cyc/s' if base['kind'] == 'workload' else 'ns/op'
+        old_shown = base['cycles_per_sec'] if unit == 'cyc/s' else base['ns_per_op']
+        new_shown = candidate[name]['cycles_per_sec'] if unit == 'cyc/s' else candidate[name]['ns_per_op']
+        flag = ''
+        if change < -threshold:
+            flag = '  REGRESSION'
+            regressions += 1
+        print(f"{name:<30} {old_shown:>14.2f} {new_shown:>14.2f} {change:>+7.1%}{flag}")
+
+    return regressions
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("Usage: python compare_bench.py <baseline.json> <candidate.json> [threshold]")
+        sys.exit(2)
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 0.10
+    sys.exit(1 if compare(sys.argv[1], sys.argv[2], threshold) else 0)
@@ -0,0 +1,6 @@
+@echo off
+if not defined VSCMD_VER call "C:\Program Files\Microsoft Visual Studio\2022\Community\VC\Auxiliary\Build\vcvars64.bat"
+cd /d %~dp0\..
+if not exist build mkdir build
+cl.exe /nologo /O2 /Fe:build\tracediff.exe src\tracediff.c /D_CRT_SECURE_NO_WARNINGS
+echo Build complete. Usage: build\tracediff.exe ^<generated_dir^> ^<reference_dir^>
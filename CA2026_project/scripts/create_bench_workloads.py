@@ -0,0 +1,164 @@
+import os
+
+# Generates the fixed benchmark workloads under inputs/bench/<name>/
+# (imem0-3.txt + memin.txt). Run from the project root:
+#   python scripts/create_bench_workloads.py
+#
+# Every workload halts well inside the 100000-cycle safety limit.
+
+OPCODES = {
+    'add': 0, 'sub': 1, 'and': 2, 'or': 3, 'xor': 4, 'mul': 5, 'sll': 6, 'sra': 7, 'srl': 8,
+    'beq': 9, 'bne': 10, 'blt': 11, 'bgt': 12, 'ble': 13, 'bge': 14, 'jal': 15,
+    'lw': 16, 'sw': 17, 'halt': 20
+}
+
+def write_hex(filename, lines):
+    with open(filename, 'w') as f:
+        for line in lines:
+            f.write(line + '\n')
+
+def reg(name):
+    if name == '$zero': return 0
+    if name == '$imm': return 1
+    return int(name[2:])
+
+# Minimal assembler for the .asm format used by save_assembly():
+#   op rd, rs, rt, imm      (labels end with ':' and may be used as imm)
+def assemble(lines):
+    labels = {}
+    pc = 0
+    for line in lines:
+        if line.endswith(':'):
+            labels[line[:-1]] = pc
+        else:
+            pc += 1
+
+    words = []
+    for line in lines:
+        if line.endswith(':'):
+            continue
+        op, _, rest = line.partition(' ')
+        args = [a.strip() for a in rest.split(',')] if rest else []
+        args += ['$zero'] * (3 - min(len(args), 3))
+        imm = args[3] if len(args) > 3 else '0'
+        imm = labels[imm] if imm in labels else int(imm, 0)
+        word = (OPCODES[op] << 24) | (reg(args[0]) << 20) | (reg(args[1]) << 16) | \
+               (reg(args[2]) << 12) | (imm & 0xFFF)
+        words.append('%08X' % word)
+    return words
+
+NOP = 'add $zero, $zero, $zero, 0'
+HALT = ['halt']
+
+def emit(name, programs, memin):
+    base_dir = os.path.join('inputs', 'bench', name)
+    os.makedirs(base_dir, exist_ok=True)
+    for core in range(4):
+        write_hex(os.path.join(base_dir, 'imem%d.txt' % core), assemble(programs[core]))
+    write_hex(os.path.join(base_dir, 'memin.txt'), ['%08X' % v for v in memin])
+
+# Compute-bound: register-only multiply/accumulate loop, no memory traffic
+def compute(core):
+    return [
+        'add $r2, $zero, $imm, 2000',
+        'add $r3, $zero, $imm, %d' % (core + 3),
+        'loop:',
+        'mul $r4, $r3, $r3, 0',
+        'add $r5, $r5, $r4, 0',
+        'xor $r6, $r5, $r3, 0',
+        'sub $r2, $r2, $imm, 1',
+        'bne $imm, $r2, $zero, loop',
+        'add $r3, $r3, $imm, 1',     # delay slot
+        'halt'
+    ]
+
+# Streaming: each core reads and rewrites its own 1024-word region
+def streaming(core):
+    return [
+        'add $r3, $zero, $imm, 0',
+        'add $r6, $zero, $imm, 1024',
+        'add $r7, $zero, $imm, %d' % core,
+        'sll $r7, $r7, $imm, 12',
+        'loop:',
+        'lw $r5, $r3, $r7, 0',
+        'add $r4, $r4, $r5, 0',
+        'sw $r4, $r3, $r7, 0',
+        'add $r3, $r3, $imm, 1',
+        'bne $imm, $r3, $r6, loop',
+        NOP,
+        'halt'
+    ]
+
+# False sharing: every core increments its own word of the same block
+def false_sharing(core):
+    return [
+        'add $r3, $zero, $imm, 200',
+        'loop:',
+        'lw $r2, $zero, $imm, %d' % core,
+        'add $r2, $r2, $imm, 1',
+        'sw $r2, $zero, $imm, %d' % core,
+        'sub $r3, $r3, $imm, 1',
+        'bne $imm, $r3, $zero, loop',
+        NOP,
+        'halt'
+    ]
+
+# Producer/consumer: core 0 fills a 512-word buffer then raises a flag at 8,
+# cores 1-2 spin on the flag and sum the buffer
+PRODUCER = [
+    'add $r4, $zero, $imm, 512',
+    'loop:',
+    'sw $r2, $r2, $imm, 256',
+    'add $r2, $r2, $imm, 1',
+    'bne $imm, $r2, $r4, loop',
+    NOP,
+    'add $r5, $zero, $imm, 1',
+    'sw $r5, $zero, $imm, 8',
+    'halt'
+]
+
+CONSUMER = [
+    'wait:',
+    'lw $r2, $zero, $imm, 8',
+    NOP,
+    'beq $imm, $r2, $zero, wait',
+    NOP,
+    'add $r6, $zero, $imm, 512',
+    'sum:',
+    'lw $r5, $r3, $imm, 256',
+    'add $r4, $r4, $r5, 0',
+    'add $r3, $r3, $imm, 1',
+    'bne $imm, $r3, $r6, sum',
+    NOP,
+    'sw $r4, $zero, $imm, 9',
+    'halt'
+]
+
+# Lock contention: token passing on word 0; the holder increments the shared
+# counter at word 64 and hands the token to the next core
+def lock_contention(core):
+    return [
+        'add $r3, $zero, $imm, 20',
+        'add $r8, $zero, $imm, %d' % core,
+        'top:',
+        'lw $r2, $zero, $imm, 0',
+        NOP,
+        'bne $imm, $r2, $r8, top',
+        NOP,
+        'lw $r4, $zero, $imm, 64',
+        'add $r4, $r4, $imm, 1',
+        'sw $r4, $zero, $imm, 64',
+        'add $r9, $zero, $imm, %d' % ((core + 1) % 4),
+        'sw $r9, $zero, $imm, 0',
+        'sub $r3, $r3, $imm, 1',
+        'bne $imm, $r3, $zero, top',
+        NOP,
+        'halt'
+    ]
+
+emit('compute', [compute(c) for c in range(4)], [0] * 8)
+emit('streaming', [streaming(c) for c in range(4)], list(range(1, 4097)))
+emit('false_sharing', [false_sharing(c) for c in range(4)], [0] * 8)
+emit('producer_consumer', [PRODUCER, CONSUMER, CONSUMER, HALT], [0] * 16)
+emit('lock_contention', [lock_contention(c) for c in range(4)], [0] * 72)
+print("Benchmark workloads created.")
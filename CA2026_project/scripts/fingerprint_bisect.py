@@ -0,0 +1,111 @@
+import os
+import subprocess
+import sys
+
+# Trace equivalence check via fingerprints (--fingerprint), with full traces
+# only where needed.
+#
+# Usage: python fingerprint_bisect.py <golden_sim> <candidate_sim> <input_dir> [interval] [work_dir]
+#   input_dir holds imem0-3.txt and memin.txt.
+#
+# Both simulators run in fingerprint mode. If the fingerprints match, the runs
+# are trace-equivalent. Otherwise both are re-run with full tracing limited to
+# the first checkpoint window whose hash differs, and the first differing line
+# of each affected trace is printed. For deeper context, run
+# build/linux/tracediff on the two trace directories.
+# Exit code: 0 equivalent, 1 divergence found.
+
+STREAMS = ['core0trace.txt', 'core1trace.txt', 'core2trace.txt', 'core3trace.txt', 'bustrace.txt']
+
+OUTPUTS = ['memout.txt', 'regout0.txt', 'regout1.txt', 'regout2.txt', 'regout3.txt'] + STREAMS[:4] + \
+          ['bustrace.txt', 'dsram0.txt', 'dsram1.txt', 'dsram2.txt', 'dsram3.txt',
+           'tsram0.txt', 'tsram1.txt', 'tsram2.txt', 'tsram3.txt',
+           'stats0.txt', 'stats1.txt', 'stats2.txt', 'stats3.txt']
+
+def run_sim(sim, input_dir, out_dir, extra_args):
+    os.makedirs(os.path.join(out_dir, 'outputs'), exist_ok=True)  # sim writes outputs/imemN.asm
+    inputs = [os.path.join(input_dir, f) for f in ['imem0.txt', 'imem1.txt', 'imem2.txt', 'imem3.txt', 'memin.txt']]
+    outputs = [os.path.join(out_dir, f) for f in OUTPUTS]
+    args = [os.path.abspath(sim)] + extra_args + [os.path.abspath(p) for p in inputs + outputs]
+    result = subprocess.run(args, cwd=out_dir, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    if result.returncode != 0:
+        print(f"Error: {sim} failed:\n{result.stderr}")
+        sys.exit(2)
+
+def load_fingerprint(filename):
+    fp = {'windows': []}
+    with open(filename, 'r') as f:
+        for line in f:
+            parts = line.split()
+            if not parts or parts[0].startswith('#'):
+                continue
+            if parts[0] == 'window':
+                fp['windows'].append((int(parts[1]), int(parts[2]), parts[3:]))
+            else:
+                fp[parts[0]] = parts[1:]
+    return fp
+
+def first_difference(golden_file, candidate_file):
+    with open(golden_file, 'r') as g, open(candidate_file, 'r') as c:
+        golden = [l.strip() for l in g]
+        candidate = [l.strip() for l in c]
+    for i, (a, b) in enumerate(zip(golden, candidate)):
+        if a != b:
+            return a, b
+    if len(golden) != len(candidate):
+        n = min(len(golden), len(candidate))
+        return (golden[n] if n < len(golden) else '<end of window>',
+                candidate[n] if n < len(candidate) else '<end of window>')
+    return None
+
+def bisect(golden_sim, candidate_sim, input_dir, interval, work_dir):
+    fp_args = ['--fingerprint-interval', str(interval)]
+    golden_fp = os.path.abspath(os.path.join(work_dir, 'golden.fp'))
+    candidate_fp = os.path.abspath(os.path.join(work_dir, 'candidate.fp'))
+    run_sim(golden_sim, input_dir, os.path.join(work_dir, 'golden'), ['--fingerprint', golden_fp] + fp_args)
+    run_sim(candidate_sim, input_dir, os.path.join(work_dir, 'candidate'), ['--fingerprint', candidate_fp] + fp_args)
+
+    golden = load_fingerprint(golden_fp)
+    candidate = load_fingerprint(candidate_fp)
+    if golden.get('total') == candidate.get('total') and golden.get('cycles') == candidate.get('cycles'):
+        print(f"Equivalent: {golden['cycles'][0]} cycles, fingerprints match")
+        return 0
+
+    # First window whose hash differs (a missing window means one run ended early)
+    for i in range(max(len(golden['windows']), len(candidate['windows']))):
+        g = golden['windows'][i] if i < len(golden['windows']) else None
+        c = candidate['windows'][i] if i < len(candidate['windows']) else None
+        if g != c:
+            break
+    window = g or c
+    start, end = window[0], window[1]
+    streams = [STREAMS[s] for s in range(len(STREAMS))
+               if not g or not c or g[2][s] != c[2][s]]
+    print(f"Divergence in cycles {start}..{end}: {', '.join(streams)}")
+    print(f"Golden cycles {golden['cycles'][0]}, candidate cycles {candidate['cycles'][0]}")
+
+    # Full traces for that window only
+    window_args = ['--trace-window', f'{start}:{end}']
+    golden_dir = os.path.join(work_dir, 'golden_window')
+    candidate_dir = os.path.join(work_dir, 'candidate_window')
+    run_sim(golden_sim, input_dir, golden_dir, window_args)
+    run_sim(candidate_sim, input_dir, candidate_dir, window_args)
+
+    for name in streams:
+        diff = first_difference(os.path.join(golden_dir, name), os.path.join(candidate_dir, name))
+        if diff:
+            print(f"\n{name}:")
+            print(f"  golden:    {diff[0]}")
+            print(f"  candidate: {diff[1]}")
+
+    print(f"\nWindowed traces: {golden_dir} vs {candidate_dir}")
+    return 1
+
+if __name__ == "__main__":
+    if len(sys.argv) < 4:
+        print("Usage: python fingerprint_bisect.py <golden_sim> <candidate_sim> <input_dir> [interval] [work_dir]")
+        sys.exit(2)
+    interval = int(sys.argv[4]) if len(sys.argv) > 4 else 1000
+    work_dir = sys.argv[5] if len(sys.argv) > 5 else 'fingerprint_work'
+    os.makedirs(work_dir, exist_ok=True)
+    sys.exit(bisect(sys.argv[1], sys.argv[2], sys.argv[3], interval, work_dir))
@@ -0,0 +1,108 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// ====================================================================================
+// HOST MEMORY ARENA
+// The trace buffers and main memory are ~260 MB. They are carved from a single
+// mapping so the small hot state in Simulator stays dense, and the mapping asks
+// for huge pages so random main memory accesses and trace writes need few TLB
+// entries. Fresh mappings are zero-filled, and untouched pages cost nothing.
+// ====================================================================================
+
+#define ARENA_HUGE_PAGE ((size_t)2 << 20)
+
+static size_t round_up(size_t n, size_t align) {
+    return (n + align - 1) & ~(align - 1);
+}
+
+bool arena_init(SimArena *arena, size_t size) {
+    memset(arena, 0, sizeof(SimArena));
+    size = round_up(size, ARENA_HUGE_PAGE);
+    void *base = NULL;
+
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege; without it this simply fails
+    SIZE_T large = GetLargePageMinimum();
+    if (large) {
+        SIZE_T large_size = round_up(size, large);
+        base = VirtualAlloc(NULL, large_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (base) {
+            size = large_size;
+            arena->kind = ARENA_HUGE_PAGES;
+        }
+    }
+    if (!base) {
+        base = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (base) arena->kind = ARENA_SMALL_PAGES;
+    }
+#else
+#ifdef MAP_HUGETLB
+    // Only succeeds when the administrator has reserved huge pages
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base == MAP_FAILED) base = NULL;
+    if (base) arena->kind = ARENA_HUGE_PAGES;
+#endif
+    if (!base) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) base = NULL;
+        if (base) {
+            arena->kind = ARENA_SMALL_PAGES;
+#ifdef MADV_HUGEPAGE
+            if (madvise(base, size, MADV_HUGEPAGE) == 0) arena->kind = ARENA_TRANSPARENT_HUGE;
+#endif
+        }
+    }
+#endif
+
+    if (!base) {
+        arena->kind = ARENA_NONE;
+        return false;
+    }
+    arena->base = (uint8_t *)base;
+    arena->size = size;
+    return true;
+}
+
+// Next ARENA_ALIGN-aligned slice, or NULL when the arena is exhausted
+void* arena_alloc(SimArena *arena, size_t size) {
+    size_t offset = round_up(arena->used, ARENA_ALIGN);
+    if (!arena->base || offset + size > arena->size) return NULL;
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+// Forget every slice; the same allocation sequence returns the same pointers
+void arena_reset(SimArena *arena) {
+    arena->used = 0;
+}
+
+void arena_release(SimArena *arena) {
+    if (arena->base) {
+#ifdef _WIN32
+        VirtualFree(arena->base, 0, MEM_RELEASE);
+#else
+        munmap(arena->base, arena->size);
+#endif
+    }
+    memset(arena, 0, sizeof(SimArena));
+}
+
+const char* arena_kind_name(ArenaKind kind) {
+    switch (kind) {
+    case ARENA_HUGE_PAGES:       return "huge pages";
+    case ARENA_TRANSPARENT_HUGE: return "transparent huge pages";
+    case ARENA_SMALL_PAGES:      return "4 KB pages";
+    default:                     return "none";
+    }
+}
@@ -0,0 +1,354 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+// Host-side benchmark driver. Built as its own executable (make bench /
+// scripts\compile_bench.bat) and linked against every simulator source except main.c.
+//
+// Runs the fixed workloads from inputs/bench/ end to end plus micro-benchmarks
+// of the hot simulator entry points, and writes the results as JSON so two
+// builds can be compared with scripts/compare_bench.py.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+// ====================================================================================
+// HOST MEASUREMENT
+// ====================================================================================
+
+static double host_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// High-water mark of the whole process: it never goes down, so it is reported
+// once per bench run, not per workload
+static long peak_rss_kb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return (long)(pmc.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss;  // KB on Linux
+    return 0;
+#endif
+}
+
+// ====================================================================================
+// RESULTS
+// ====================================================================================
+
+#define MAX_RESULTS 32
+
+typedef struct {
+    char name[64];
+    const char *kind;            // "workload" or "micro"
+    uint64_t iterations;         // Workload repetitions or micro-benchmark operations
+    double seconds;              // Host time, measured section only
+    uint64_t sim_cycles;         // Workloads: simulated cycles (all repetitions)
+    uint64_t instructions;       // Workloads: retired instructions, all cores
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static int num_results = 0;
+
+static BenchResult *add_result(const char *name, const char *kind) {
+    BenchResult *r = &results[num_results < MAX_RESULTS ? num_results++ : MAX_RESULTS - 1];
+    memset(r, 0, sizeof(BenchResult));
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->kind = kind;
+    return r;
+}
+
+static void print_result(const BenchResult *r) {
+    if (strcmp(r->kind, "workload") == 0) {
+        printf("%-28s %10.3f s  %12.0f cycles/s  %12.0f instr/s\n", r->name, r->seconds,
+               r->seconds > 0 ? r->sim_cycles / r->seconds : 0.0,
+               r->seconds > 0 ? r->instructions / r->seconds : 0.0);
+    } else {
+        printf("%-28s %10.3f s  %12.2f ns/op\n", r->name, r->seconds,
+               r->iterations ? r->seconds * 1e9 / (double)r->iterations : 0.0);
+    }
+}
+
+static bool write_json(const char *filename, long peak_rss) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "{\n  \"build\": \"%s %s\",\n  \"peak_rss_kb\": %ld,\n  \"results\": [\n",
+            __DATE__, __TIME__, peak_rss);
+    for (int i = 0; i < num_results; i++) {
+        BenchResult *r = &results[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"kind\": \"%s\", \"iterations\": %llu, \"seconds\": %.6f, "
+                    "\"sim_cycles\": %llu, \"instructions\": %llu, \"cycles_per_sec\": %.1f, "
+                    "\"instructions_per_sec\": %.1f, \"ns_per_op\": %.3f}%s\n",
+                r->name, r->kind, (unsigned long long)r->iterations, r->seconds,
+                (unsigned long long)r->sim_cycles, (unsigned long long)r->instructions,
+                r->seconds > 0 ? r->sim_cycles / r->seconds : 0.0,
+                r->seconds > 0 ? r->instructions / r->seconds : 0.0,
+                r->iterations ? r->seconds * 1e9 / (double)r->iterations : 0.0,
+                (i < num_results - 1) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+
+    fclose(fp);
+    return true;
+}
+
+// ====================================================================================
+// WORKLOADS
+// ====================================================================================
+
+static const char *WORKLOADS[] = {
+    "compute", "streaming", "false_sharing", "producer_consumer", "lock_contention"
+};
+#define NUM_WORKLOADS (int)(sizeof(WORKLOADS) / sizeof(WORKLOADS[0]))
+
+static bool load_workload(Simulator *sim, const char *dir, const char *name) {
+    char path[512];
+
+    init_simulator(sim);
+    for (int i = 0; i < NUM_CORES; i++) {
+        snprintf(path, sizeof(path), "%s/%s/imem%d.txt", dir, name, i);
+        if (!load_imem(path, sim->cores[i].imem)) return false;
+    }
+    snprintf(path, sizeof(path), "%s/%s/memin.txt", dir, name);
+    return load_memin(path, &sim->main_memory);
+}
+
+static bool bench_workload(Simulator *sim, const char *dir, const char *name, int reps) {
+    char label[64];
+    snprintf(label, sizeof(label), "workload/%s", name);
+    BenchResult *r = add_result(label, "workload");
+
+    for (int rep = 0; rep < reps; rep++) {
+        if (!load_workload(sim, dir, name)) return false;
+
+        double start = host_seconds();
+        run_simulator(sim);
+        r->seconds += host_seconds() - start;
+
+        r->sim_cycles += sim->global_cycle;
+        for (int i = 0; i < NUM_CORES; i++) r->instructions += sim->cores[i].instructions;
+        r->iterations++;
+    }
+    return true;
+}
+
+// ====================================================================================
+// MICRO-BENCHMARKS
+// ====================================================================================
+
+static volatile uint32_t sink;  // Keeps results alive so the compiler cannot drop the work
+
+static void bench_decode(uint64_t ops) {
+    uint32_t words[IMEM_SIZE];
+    uint32_t seed = 12345;
+    for (int i = 0; i < IMEM_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        words[i] = seed;
+    }
+
+    BenchResult *r = add_result("micro/decode_instruction", "micro");
+    uint32_t acc = 0;
+    double start = host_seconds();
+    for (uint64_t i = 0; i < ops; i++) {
+        Instruction inst = decode_instruction(words[i & (IMEM_SIZE - 1)]);
+        acc += inst.opcode + inst.rd + (uint32_t)inst.imm;
+    }
+    r->seconds = host_seconds() - start;
+    r->iterations = ops;
+    sink = acc;
+}
+
+// Every core keeps a request pending so the bus cycles through full transactions
+static void bench_bus_cycle(Simulator *sim, uint64_t ops) {
+    init_simulator(sim);
+    BenchResult *r = add_result("micro/bus_cycle", "micro");
+
+    double start = host_seconds();
+    for (uint64_t i = 0; i < ops; i++) {
+        for (int c = 0; c < NUM_CORES; c++) {
+            if (!sim->bus.pending[c] && sim->bus.owner != c) {
+                uint32_t addr = (uint32_t)((i * 8 + c * 4096) & (MAIN_MEM_SIZE - 1));
+                bus_request(&sim->bus, c, (c & 1) ? BUS_RDX : BUS_RD, addr, 0, sim->global_cycle);
+            }
+        }
+        bus_cycle(sim);
+        sim->bus.trace_count = 0;  // Keep formatting trace lines instead of hitting the cap
+        sim->global_cycle++;
+    }
+    r->seconds = host_seconds() - start;
+    r->iterations = ops;
+}
+
+// One core running the compute workload; restarted whenever it halts
+static bool bench_core_cycle(Simulator *sim, const char *dir, uint64_t ops) {
+    if (!load_workload(sim, dir, "compute")) return false;
+    uint32_t imem[IMEM_SIZE];
+    memcpy(imem, sim->cores[0].imem, sizeof(imem));
+
+    BenchResult *r = add_result("micro/execute_core_cycle", "micro");
+    double start = host_seconds();
+    for (uint64_t i = 0; i < ops; i++) {
+        Core *core = &sim->cores[0];
+        if (core->halted) {
+            init_core(core, 0);
+            init_core_tags(&sim->tags, 0);
+            memcpy(core->imem, imem, sizeof(imem));
+        }
+        execute_core_cycle(core, sim);
+        core->trace_count = 0;
+    }
+    r->seconds = host_seconds() - start;
+    r->iterations = ops;
+    return true;
+}
+
+static void bench_trace_format(Simulator *sim, uint64_t ops) {
+    init_simulator(sim);
+    Core *core = &sim->cores[0];
+    for (int i = 2; i < NUM_REGISTERS; i++) core->registers[i] = 0x01234567u * i;
+    core->pipeline.decode.valid = true;
+    core->pipeline.mem.valid = true;
+
+    BenchResult *r = add_result("micro/log_cycle_trace", "micro");
+    double start = host_seconds();
+    for (uint64_t i = 0; i < ops; i++) {
+        core->cycles = i;
+        log_cycle_trace(core);
+        core->trace_count = 0;
+    }
+    r->seconds = host_seconds() - start;
+    r->iterations = ops;
+
+    BusTransaction trans = { 1, BUS_FLUSH, 0x1234, 0xDEADBEEF, true };
+    r = add_result("micro/add_bus_trace_entry", "micro");
+    start = host_seconds();
+    for (uint64_t i = 0; i < ops; i++) {
+        add_bus_trace_entry(&sim->bus, &trans, i);
+        sim->bus.trace_count = 0;
+    }
+    r->seconds = host_seconds() - start;
+    r->iterations = ops;
+}
+
+// End-of-run writers on the state left by a full streaming run
+static bool bench_writers(Simulator *sim, const char *dir, const char *tmp_dir, int reps) {
+    char path[512];
+    if (!load_workload(sim, dir, "streaming")) return false;
+    run_simulator(sim);
+
+    struct { const char *name; int kind; } writers[] = {
+        { "save_memout", 0 }, { "save_regout", 1 }, { "save_trace", 2 }, { "save_bustrace", 3 },
+        { "save_dsram", 4 }, { "save_tsram", 5 }, { "save_stats", 6 }
+    };
+
+    for (int w = 0; w < (int)(sizeof(writers) / sizeof(writers[0])); w++) {
+        char label[64];
+        snprintf(label, sizeof(label), "micro/%s", writers[w].name);
+        snprintf(path, sizeof(path), "%s/bench_%s.txt", tmp_dir, writers[w].name);
+        BenchResult *r = add_result(label, "micro");
+
+        double start = host_seconds();
+        for (int rep = 0; rep < reps; rep++) {
+            bool ok = true;
+            switch (writers[w].kind) {
+            case 0: ok = save_memout(path, &sim->main_memory); break;
+            case 1: ok = save_regout(path, &sim->cores[0]); break;
+            case 2: ok = save_trace(path, &sim->cores[0]); break;
+            case 3: ok = save_bustrace(path, &sim->bus); break;
+            case 4: ok = save_dsram(path, &sim->cores[0].cache); break;
+            case 5: ok = save_tsram(path, &sim->tags, 0); break;
+            case 6: ok = save_stats(path, &sim->cores[0]); break;
+            }
+            if (!ok) return false;
+        }
+        r->seconds = host_seconds() - start;
+        r->iterations = reps;
+        remove(path);
+    }
+    return true;
+}
+
+// ====================================================================================
+// DRIVER
+// ====================================================================================
+
+int main(int argc, char *argv[]) {
+    const char *input_dir = "inputs/bench";
+    const char *json_file = "bench_results.json";
+    const char *tmp_dir = ".";
+    int reps = 3;
+    uint64_t micro_ops = 2000000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--inputs") == 0 && i + 1 < argc) input_dir = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) json_file = argv[++i];
+        else if (strcmp(argv[i], "--tmp") == 0 && i + 1 < argc) tmp_dir = argv[++i];
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--quick") == 0) { reps = 1; micro_ops = 200000; }
+        else {
+            fprintf(stderr, "Usage: %s [--inputs DIR] [--json FILE] [--tmp DIR] [--reps N] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    Simulator *sim = alloc_simulator();
+    if (!sim) {
+        fprintf(stderr, "Error: Failed to allocate memory for simulator\n");
+        return 1;
+    }
+
+    bool ok = true;
+    for (int w = 0; w < NUM_WORKLOADS && ok; w++) {
+        ok = bench_workload(sim, input_dir, WORKLOADS[w], reps);
+    }
+    if (ok) {
+        bench_decode(micro_ops * 10);
+        bench_bus_cycle(sim, micro_ops);
+        ok = bench_core_cycle(sim, input_dir, micro_ops);
+    }
+    if (ok) {
+        bench_trace_format(sim, micro_ops);
+        ok = bench_writers(sim, input_dir, tmp_dir, reps);
+    }
+    free_simulator(sim);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Benchmark setup failed (run from the project root or pass --inputs)\n");
+        return 1;
+    }
+
+    printf("\nBenchmark results:\n");
+    for (int i = 0; i < num_results; i++) print_result(&results[i]);
+    long peak_rss = peak_rss_kb();
+    printf("Peak RSS: %ld KB\n", peak_rss);
+
+    return write_json(json_file, peak_rss) ? 0 : 1;
+}
@@ -13,7 +13,7 @@ static inline uint32_t get_block_base_addr(uint32_t addr) {
 // BUS ARBITER - Round-Robin Arbitration with 2-cycle latency
 // ====================================================================================
 
-void bus_request(BusArbiter *bus, int core_id, BusCommand cmd, uint32_t addr, uint32_t data) {
+void bus_request(BusArbiter *bus, int core_id, BusCommand cmd, uint32_t addr, uint32_t data, uint64_t cycle) {
     if (core_id < 0 || core_id >= NUM_CORES) return;
 
     bus->pending_trans[core_id].origid = core_id;
@@ -22,11 +22,24 @@ void bus_request(BusArbiter *bus, int core_id, BusCommand cmd, uint32_t addr, ui
     bus->pending_trans[core_id].data = data;
     bus->pending_trans[core_id].shared = false;
     bus->pending[core_id] = true;
+    bus->request_time[core_id] = cycle;
     // Note: In some traces, the request happens during the MEM stage of cycle T.
     // The command appears on the bus at T+2.
 }
 
-void bus_arbitrate(BusArbiter *bus) {
+// Record how long the granted request sat in pending[]
+static void bus_record_queue_delay(BusArbiter *bus, int core_id, uint64_t cycle) {
+    BusQueueStats *q = &bus->queue[core_id];
+    uint64_t delay = cycle - bus->request_time[core_id];
+
+    q->requests++;
+    q->total_delay += delay;
+    if (delay > q->max_delay) q->max_delay = delay;
+    if (delay >= bus->starvation_threshold) q->starved++;
+    q->hist[delay < BUS_QUEUE_HIST_SIZE ? delay : BUS_QUEUE_HIST_SIZE - 1]++;
+}
+
+void bus_arbitrate(BusArbiter *bus, uint64_t cycle) {
     int start = (bus->last_granted + 1) % NUM_CORES; // Round-robin start point 
     for (int i = 0; i < NUM_CORES; i++) {
         int core_id = (start + i) % NUM_CORES;
@@ -35,6 +48,8 @@ void bus_arbitrate(BusArbiter *bus) {
             bus->last_granted = core_id; // Mandatory for fair RR 
             bus->current = bus->pending_trans[core_id];
             bus->pending[core_id] = false; // Clear request once granted
+            bus->grant_time = cycle;
+            bus_record_queue_delay(bus, core_id, cycle);
             return;
         }
     }
@@ -43,11 +58,14 @@ void bus_cycle(Simulator* sim) {
     BusArbiter* bus = &sim->bus;
     BusTransaction output = { 0 };
     output.cmd = BUS_NO_CMD;
+#if PERF_COUNTERS
+    BusState entry_state = bus->state;
+#endif
 
     switch (bus->state) {
     case BUS_STATE_IDLE:
         bus->owner = -1;
-        bus_arbitrate(bus);
+        bus_arbitrate(bus, sim->global_cycle);
         if (bus->owner != -1) {
             bus->state = BUS_STATE_ARBITRATE;
         }
@@ -64,9 +82,16 @@ void bus_cycle(Simulator* sim) {
         output.shared = false;
 
         // SNOOP: Other cores signal 'shared' and provide data if Modified
-        for (int i = 0; i < 4; i++) {
-            if (i != bus->owner) cache_snoop(&sim->cores[i].cache, &output, i, sim);
+        PROFILE_BEGIN(PROF_SNOOP);
+        // One directory probe gives every cache's state for the block; only holders snoop
+        {
+            uint64_t holders = tag_dir_probe(&sim->tags, output.addr);
+            for (int i = 0; i < 4; i++) {
+                MESIState state = tag_lane_state(holders, i);
+                if (i != bus->owner && state != MESI_INVALID) cache_snoop(&sim->cores[i].cache, &output, state, i, sim);
+            }
         }
+        PROFILE_END(PROF_SNOOP);
         bus->shared_at_request = output.shared;
         
         // Trace Logic for compatibility with reference:
@@ -76,7 +101,17 @@ void bus_cycle(Simulator* sim) {
         if (bus->provider_id != 4) {
             trace_trans.shared = false;
         }
-        add_bus_trace_entry(bus, &trace_trans, sim->global_cycle);
+        PROFILE_BEGIN(PROF_BUS_TRACE);
+        if (sim->fingerprint.enabled) {
+            fingerprint_bus(&sim->fingerprint, sim->global_cycle, &trace_trans);
+        } else {
+            char *line = trace_claim_line(sim, TRACE_STREAM_BUS, bus->trace_lines, &bus->trace_count, &bus->trace_ring);
+            if (line) format_bus_trace(&trace_trans, sim->global_cycle, line);
+        }
+        PROFILE_END(PROF_BUS_TRACE);
+        if (sim->hooks.on_bus) sim->hooks.on_bus(sim->hooks.user, &trace_trans, sim->global_cycle);
+        PERF_INC(bus->perf, output.cmd == BUS_RD ? PERF_BUS_CMD_RD : PERF_BUS_CMD_RDX);
+        PERF_INC(bus->perf, bus->provider_id != 4 ? PERF_BUS_C2C_SUPPLIES : PERF_BUS_MEM_SUPPLIES);
 
         if (bus->provider_id != 4) {
             bus->state = BUS_STATE_FLUSH;
@@ -84,7 +119,11 @@ void bus_cycle(Simulator* sim) {
         }
         else {
             bus->state = BUS_STATE_LATENCY;
-            bus->timer = 15; // Exact 16-cycle latency (current cycle + 15)
+            // Exact MAIN_MEM_LATENCY (current cycle + 15), or the shared LLC's (--llc), or the
+            // banked DRAM model's (--dram)
+            if (sim->llc.enabled) bus->timer = llc_read(sim, output.addr) - 1;
+            else if (sim->dram.enabled) bus->timer = (int)dram_read(&sim->dram, output.addr, sim->global_cycle) - 1;
+            else bus->timer = MAIN_MEM_LATENCY - 1;
             uint32_t block_addr = output.addr & ~0x7;
             for (int j = 0; j < 8; j++) {
                 bus->flush_data[j] = sim->main_memory.data[block_addr + j];
@@ -111,40 +150,82 @@ void bus_cycle(Simulator* sim) {
         output.data = bus->flush_data[offset];
         output.shared = bus->shared_at_request;
 
-        add_bus_trace_entry(bus, &output, sim->global_cycle);
-
-        // Parallel Memory Update
-        if (bus->provider_id != 4) sim->main_memory.data[output.addr] = output.data;
-
-        // Data Capture: Requester saves the word to its DSRAM
-        for (int i = 0; i < 4; i++) {
-            cache_handle_bus_response(&sim->cores[i].cache, &output, i, sim);
+        {
+            PROFILE_BEGIN(PROF_BUS_TRACE);
+            if (sim->fingerprint.enabled) {
+                fingerprint_bus(&sim->fingerprint, sim->global_cycle, &output);
+            } else {
+                char *line = trace_claim_line(sim, TRACE_STREAM_BUS, bus->trace_lines, &bus->trace_count, &bus->trace_ring);
+                if (line) format_bus_trace(&output, sim->global_cycle, line);
+            }
+            PROFILE_END(PROF_BUS_TRACE);
         }
+        if (sim->hooks.on_bus) sim->hooks.on_bus(sim->hooks.user, &output, sim->global_cycle);
+        PERF_INC(bus->perf, PERF_BUS_CMD_FLUSH);
 
+        // Data movement is block-granular. Until the last word arrives nothing can
+        // observe the requester's set (its core is stalled on it, the old tag stays
+        // installed and no snoop can start while the bus is busy) or the block in
+        // main memory, so the whole block moves at once when the fill commits.
+        // bus_sync_flush() materializes the words of a fill cut short.
         bus->timer--;
         if (bus->timer == 0) {
+            // Parallel Memory Update (cache-to-cache transfers write memory too)
+            if (bus->provider_id != 4) {
+                memcpy(&sim->main_memory.data[base], bus->flush_data, sizeof(bus->flush_data));
+                memory_mark_dirty(&sim->main_memory, base, CACHE_BLOCK_SIZE);
+                bool in_llc = sim->llc.enabled && llc_write(sim, base);
+                if (sim->dram.enabled && !in_llc) dram_write(&sim->dram, base, sim->global_cycle);
+            }
+            // Data Capture: Requester installs the block (an exclusive LLC takes the block it replaces)
+            if (sim->llc.enabled) llc_l1_victim(sim, bus->owner, base);
+            cache_fill_block(&sim->cores[bus->owner].cache, base, bus->flush_data, CACHE_BLOCK_SIZE, true,
+                             bus->owner, sim);
+
+            // Transaction occupied the bus from its grant cycle through this last flush word
+            BusUtilType type = (bus->pending_trans[bus->owner].cmd == BUS_RD)
+                ? (bus->provider_id != 4 ? BUS_UTIL_RD_C2C : BUS_UTIL_RD_MEM)
+                : (bus->provider_id != 4 ? BUS_UTIL_RDX_C2C : BUS_UTIL_RDX_MEM);
+            bus->util_cycles[type] += sim->global_cycle - bus->grant_time + 1;
+            bus->util_count[type]++;
+
             bus->state = BUS_STATE_IDLE;
             bus->owner = -1;
         }
         break;
     }
+
+#if PERF_COUNTERS
+    // Idle only if we started idle and arbitration found nobody to grant
+    if (entry_state == BUS_STATE_IDLE && bus->owner == -1) PERF_INC(bus->perf, PERF_BUS_IDLE_CYCLES);
+    else PERF_INC(bus->perf, PERF_BUS_BUSY_CYCLES);
+#endif
 }
 void add_bus_trace_entry(BusArbiter *bus, BusTransaction *trans, uint64_t cycle) {
     if (trans == NULL || trans->cmd == BUS_NO_CMD) return;
     if (bus->trace_count >= MAX_TRACE_LINES) return;
 
-    snprintf(bus->trace_lines[bus->trace_count], TRACE_LINE_SIZE,
-             "%llu %d %d %06X %08X %d",
-             (unsigned long long)cycle,
-             trans->origid,
-             (int)trans->cmd,
-             trans->addr & 0xFFFFF,
-             trans->data,
-             trans->shared ? 1 : 0);
-
+    format_bus_trace(trans, cycle, bus->trace_lines[bus->trace_count]);
     bus->trace_count++;
 }
 
+// Format one bus trace line: cycle origid cmd addr data shared
+void format_bus_trace(BusTransaction *trans, uint64_t cycle, char *buffer) {
+    // Same layout as "%llu %d %d %06X %08X %d"
+    char *p = fmt_u64(buffer, cycle);
+    *p++ = ' ';
+    p = fmt_u64(p, (uint64_t)trans->origid);
+    *p++ = ' ';
+    p = fmt_u64(p, (uint64_t)trans->cmd);
+    *p++ = ' ';
+    p = fmt_hex(p, trans->addr & 0xFFFFF, 6);
+    *p++ = ' ';
+    p = fmt_hex(p, trans->data, 8);
+    *p++ = ' ';
+    *p++ = trans->shared ? '1' : '0';
+    *p = '\0';
+}
+
 // Memory utility functions
 uint32_t memory_read_word(MainMemory *mem, uint32_t addr) {
     if (addr < MAIN_MEM_SIZE) return mem->data[addr];
@@ -152,7 +233,10 @@ uint32_t memory_read_word(MainMemory *mem, uint32_t addr) {
 }
 
 void memory_write_word(MainMemory *mem, uint32_t addr, uint32_t data) {
-    if (addr < MAIN_MEM_SIZE) mem->data[addr] = data;
+    if (addr < MAIN_MEM_SIZE) {
+        mem->data[addr] = data;
+        memory_mark_dirty(mem, addr, 1);
+    }
 }
 
 void memory_read_block(MainMemory *mem, uint32_t block_addr, uint32_t *block_data) {
@@ -168,6 +252,24 @@ void memory_write_block(MainMemory *mem, uint32_t block_addr, uint32_t *block_da
         uint32_t addr = block_addr + i;
         if (addr < MAIN_MEM_SIZE) mem->data[addr] = block_data[i];
     }
+    memory_mark_dirty(mem, block_addr, CACHE_BLOCK_SIZE);
+}
+
+// Write the words of an in-progress flush that have already been on the bus,
+// exactly as the word-by-word transfer would have left them. The tag is not
+// installed until the block completes. Call before inspecting caches or memory
+// while a fill may be in flight (run_simulator does so when the run stops).
+void bus_sync_flush(Simulator *sim) {
+    BusArbiter *bus = &sim->bus;
+    if (bus->state != BUS_STATE_FLUSH || bus->owner < 0) return;
+
+    uint32_t base = bus->pending_trans[bus->owner].addr & ~0x7;
+    int delivered = CACHE_BLOCK_SIZE - bus->timer;
+    if (bus->provider_id != 4) {
+        memcpy(&sim->main_memory.data[base], bus->flush_data, (size_t)delivered * sizeof(uint32_t));
+        memory_mark_dirty(&sim->main_memory, base, (uint32_t)delivered);
+    }
+    cache_fill_block(&sim->cores[bus->owner].cache, base, bus->flush_data, delivered, false, bus->owner, sim);
 }
 
 void memory_cycle(MainMemory *mem, BusTransaction *bus_trans, Simulator *sim) {
@@ -37,14 +37,13 @@ static inline uint32_t get_addr_from_tag_index(uint16_t tag, uint8_t index) {
 // CACHE OPERATIONS (Transitions and Requests)
 // ====================================================================================
 
-bool cache_read(Cache* cache, uint32_t addr, uint32_t* data, Simulator* sim, int core_id) {
+bool cache_read(Cache* cache, uint32_t addr, MESIState state, uint32_t* data, Simulator* sim, int core_id) {
     uint8_t index = get_cache_index(addr); 
-    uint16_t tag = get_cache_tag(addr);
     uint8_t block_offset = get_block_offset(addr);
-    TSRAMEntry* entry = &cache->tsram[index]; 
+    TSRAMEntry entry = tag_dir_get(&sim->tags, index, core_id);
 
     // 1. Check for a Cache Hit
-    if (entry->valid && entry->tag == tag && entry->mesi_state != MESI_INVALID) {
+    if (state != MESI_INVALID) {
         uint16_t dsram_idx = index * CACHE_BLOCK_SIZE + block_offset;
         *data = cache->dsram[dsram_idx]; // Read data
         
@@ -56,16 +55,13 @@ bool cache_read(Cache* cache, uint32_t addr, uint32_t* data, Simulator* sim, int
     if (!sim->bus.pending[core_id] && sim->bus.owner != core_id) {
        
         // If we have a Modified block at this index, we must write it back first (Conflict Miss)
-        if (entry->valid && entry->mesi_state == MESI_MODIFIED) {
+        if (tsram_state(entry) == MESI_MODIFIED) {
             // In a real MESI system, you'd issue a Flush here. 
             // For this project, you can handle the write-back as a separate Bus transaction if needed.
         }
 
         // Issue the Bus Read (BusRd)
-        sim->bus.pending_trans[core_id].cmd = 1; // 1: BusRd 
-        sim->bus.pending_trans[core_id].addr = addr; 
-        sim->bus.pending_trans[core_id].origid = core_id; 
-        sim->bus.pending[core_id] = true; 
+        bus_request(&sim->bus, core_id, BUS_RD, addr, 0, sim->global_cycle);
         
         // sim->cores[core_id].read_miss++; // STATS - Moved to core.c
     }
@@ -73,18 +69,15 @@ bool cache_read(Cache* cache, uint32_t addr, uint32_t* data, Simulator* sim, int
     // Still a miss until the Bus finishes the 8-word Flush
     return false; 
 }
-bool cache_write(Cache* cache, uint32_t addr, uint32_t data, Simulator* sim, int core_id) {
+bool cache_write(Cache* cache, uint32_t addr, MESIState state, uint32_t data, Simulator* sim, int core_id) {
     uint8_t index = get_cache_index(addr);
-    uint16_t tag = get_cache_tag(addr);
     uint8_t block_offset = get_block_offset(addr);
-    TSRAMEntry* entry = &cache->tsram[index];
 
     // Hit only if we already "Own" the block (Modified or Exclusive) 
-    if (entry->valid && entry->tag == tag &&
-        (entry->mesi_state == 3 || entry->mesi_state == 2)) {
+    if (state == 3 || state == 2) {
         uint16_t dsram_idx = index * CACHE_BLOCK_SIZE + block_offset;
         cache->dsram[dsram_idx] = data;
-        entry->mesi_state = 3; // Move to Modified 
+        tag_dir_set(&sim->tags, index, core_id, tsram_make(get_cache_tag(addr), MESI_MODIFIED)); // Move to Modified 
         
         // sim->cores[core_id].write_hit++; // STATS - Moved to core.c
         return true;
@@ -92,10 +85,7 @@ bool cache_write(Cache* cache, uint32_t addr, uint32_t data, Simulator* sim, int
 
     // Miss or Shared: Must issue a full BusRdX (command 2) [cite: 48, 53]
     if (!sim->bus.pending[core_id] && sim->bus.owner != core_id) {
-        sim->bus.pending_trans[core_id].cmd = 2; // BusRdX [cite: 48]
-        sim->bus.pending_trans[core_id].addr = addr;
-        sim->bus.pending_trans[core_id].origid = core_id;
-        sim->bus.pending[core_id] = true;
+        bus_request(&sim->bus, core_id, BUS_RDX, addr, 0, sim->global_cycle); // BusRdX [cite: 48]
         
         // sim->cores[core_id].write_miss++; // STATS - Moved to core.c
     }
@@ -106,15 +96,17 @@ bool cache_write(Cache* cache, uint32_t addr, uint32_t data, Simulator* sim, int
 // SNOOPING AND RESPONSE HANDLING
 // ====================================================================================
 
-void cache_snoop(Cache* cache, BusTransaction* trans, int core_id, Simulator* sim) {
+// state: this cache's state for the block, from the bus's tag_dir_probe()
+void cache_snoop(Cache* cache, BusTransaction* trans, MESIState state, int core_id, Simulator* sim) {
     uint8_t index = get_cache_index(trans->addr);
     uint16_t tag = get_cache_tag(trans->addr);
-    TSRAMEntry* entry = &cache->tsram[index];
 
-    if (!entry->valid || entry->tag != tag) return; // Miss - don't have this block
+    if (state == MESI_INVALID) return; // Miss - don't have this block
+    if (sim->spin.enabled) spin_snoop(sim, core_id, trans->addr, trans->cmd == 2);
+    if (sim->sharing.enabled) sharing_snoop(sim, core_id, trans->addr, trans->cmd, state);
 
     if (trans->cmd == 1) { // BusRd
-        if (entry->mesi_state == 3) { // Modified -> Shared
+        if (state == 3) { // Modified -> Shared
             // This cache must provide the data
             sim->bus.provider_id = core_id;
             // Calculate proper DSRAM offset for this cache block
@@ -122,29 +114,36 @@ void cache_snoop(Cache* cache, BusTransaction* trans, int core_id, Simulator* si
             for (int i = 0; i < CACHE_BLOCK_SIZE; i++) {
                 sim->bus.flush_data[i] = cache->dsram[dsram_base + i];
             }
-            entry->mesi_state = 1; // Transition to Shared
+            tag_dir_set(&sim->tags, index, core_id, tsram_make(tag, MESI_SHARED)); // Transition to Shared
             trans->shared = 1;
+            PERF_INC(sim->cores[core_id].perf, PERF_C2C_SUPPLIES);
+            PERF_INC(sim->cores[core_id].perf, PERF_SNOOP_DOWNGRADES);
         }
-        else if (entry->mesi_state == 2) { // Exclusive -> Shared
-            entry->mesi_state = 1;
+        else if (state == 2) { // Exclusive -> Shared
+            tag_dir_set(&sim->tags, index, core_id, tsram_make(tag, MESI_SHARED));
             trans->shared = 1;
+            PERF_INC(sim->cores[core_id].perf, PERF_SNOOP_DOWNGRADES);
         }
-        else if (entry->mesi_state == 1) { // Shared -> Shared
+        else if (state == 1) { // Shared -> Shared
             trans->shared = 1;
         }
     }
     else if (trans->cmd == 2) { // BusRdX
-        if (entry->mesi_state == 3) { // Modified -> Invalid
+        if (state == 3) { // Modified -> Invalid
             // This cache must provide the data
             sim->bus.provider_id = core_id;
             uint16_t dsram_base = index * CACHE_BLOCK_SIZE;
             for (int i = 0; i < CACHE_BLOCK_SIZE; i++) {
                 sim->bus.flush_data[i] = cache->dsram[dsram_base + i];
             }
+            PERF_INC(sim->cores[core_id].perf, PERF_C2C_SUPPLIES);
         }
         // All states (M, E, S) -> Invalid
-        entry->mesi_state = 0;
-        entry->valid = false;
+        if (state != MESI_INVALID) {
+            PERF_INC(sim->cores[core_id].perf, PERF_SNOOP_INVALIDATIONS);
+            if (sim->options.miss_classify) miss_classify_invalidation(sim, core_id, trans->addr);
+        }
+        tag_dir_set(&sim->tags, index, core_id, tsram_make(tag, MESI_INVALID));
     }
 }
 
@@ -152,31 +151,103 @@ void cache_snoop(Cache* cache, BusTransaction* trans, int core_id, Simulator* si
 // BUS RESPONSE HANDLING
 // ====================================================================================
 
-void cache_handle_bus_response(Cache* cache, BusTransaction* trans, int core_id, Simulator* sim) {
-    if (trans->cmd != 3) return; // Only care about BUS_FLUSH
+// The requester (bus owner) receives the flushed block. Called with the first
+// `words` words of the block; `commit` once all 8 have arrived, which installs
+// the tag with its final MESI state.
+void cache_fill_block(Cache* cache, uint32_t block_addr, const uint32_t* data, int words, bool commit,
+                      int core_id, Simulator* sim) {
+    uint8_t index = get_cache_index(block_addr);
+    memcpy(&cache->dsram[get_dsram_index(index, 0)], data, (size_t)words * sizeof(uint32_t));
+
+    if (commit) {
+        uint16_t tag = get_cache_tag(block_addr);
+        // Set final MESI state based on the requester's command
+        MESIState state;
+        if (sim->bus.pending_trans[core_id].cmd == 1) {
+            state = sim->bus.shared_at_request ? MESI_SHARED : MESI_EXCLUSIVE;
+        }
+        else {
+            state = MESI_MODIFIED;
+        }
+        tag_dir_set(&sim->tags, index, core_id, tsram_make(tag, state));
+        if (sim->sharing.enabled) sharing_fill(sim, core_id, block_addr);
+        // Release stall when block is complete - REMOVED to align with Reference Timing
+        // Stall clears in next cycle's stage_memory() when cache_read() hits
+        // sim->cores[core_id].pipeline.mem.internal_stall = false;
+    }
+}
+
+// ====================================================================================
+// CONSISTENCY CHECK
+// ====================================================================================
 
-    if (sim->bus.owner == core_id) {
-        // Calculate proper DSRAM index for this word
-        uint8_t index = get_cache_index(trans->addr);
-        uint8_t block_offset = get_block_offset(trans->addr);
-        uint16_t dsram_idx = index * CACHE_BLOCK_SIZE + block_offset;
-        cache->dsram[dsram_idx] = trans->data;
-
-        // Finalize block on the 8th word (offset 7)
-        if (block_offset == 7) {
-            uint16_t tag = get_cache_tag(trans->addr);
-            cache->tsram[index].tag = tag;
-            cache->tsram[index].valid = true;
-            // Set final MESI state based on the requester's command
-            if (sim->bus.pending_trans[core_id].cmd == 1) {
-                cache->tsram[index].mesi_state = sim->bus.shared_at_request ? 1 : 2;
+// MESI invariants over all caches (used when caches are loaded, not filled):
+// - a Modified or Exclusive block is valid in no other cache;
+// - a Shared or Exclusive copy is clean: it equals main memory.
+bool check_cache_coherence(Simulator *sim) {
+    bool ok = true;
+    for (int core_id = 0; core_id < NUM_CORES; core_id++) {
+        Cache *cache = &sim->cores[core_id].cache;
+        for (int index = 0; index < NUM_CACHE_BLOCKS; index++) {
+            TSRAMEntry entry = tag_dir_get(&sim->tags, index, core_id);
+            MESIState state = tsram_state(entry);
+            if (state == MESI_INVALID) continue;
+            uint32_t block = ((uint32_t)tsram_tag(entry) << 9) | ((uint32_t)index << 3);
+
+            uint64_t holders = tag_dir_probe(&sim->tags, block);
+            for (int other = 0; other < NUM_CORES; other++) {
+                if (other == core_id || tag_lane_state(holders, other) == MESI_INVALID) continue;
+                if (state == MESI_MODIFIED || state == MESI_EXCLUSIVE) {
+                    fprintf(stderr, "Error: Block %06X is %s in core %d but also cached by core %d\n",
+                            block, state == MESI_MODIFIED ? "Modified" : "Exclusive", core_id, other);
+                    ok = false;
+                }
+            }
+
+            if (state == MESI_MODIFIED) continue;
+            for (int w = 0; w < CACHE_BLOCK_SIZE; w++) {
+                uint32_t cached = cache->dsram[get_dsram_index(index, w)];
+                if (cached != sim->main_memory.data[block + w]) {
+                    fprintf(stderr, "Error: Core %d holds block %06X clean (%s) but word %06X is %08X, memory %08X\n",
+                            core_id, block, state == MESI_SHARED ? "Shared" : "Exclusive",
+                            block + w, cached, sim->main_memory.data[block + w]);
+                    ok = false;
+                    break;
+                }
             }
-            else {
-                cache->tsram[index].mesi_state = 3;
+        }
+    }
+    return ok;
+}
+
+// Every Modified line over image, a copy of main memory: image then holds what
+// a load would see. A warm start can load Modified lines newer than memory.
+void cache_overlay_modified(Simulator *sim, uint32_t *image) {
+    for (int core_id = 0; core_id < NUM_CORES; core_id++) {
+        for (int index = 0; index < NUM_CACHE_BLOCKS; index++) {
+            TSRAMEntry entry = tag_dir_get(&sim->tags, index, core_id);
+            if (tsram_state(entry) != MESI_MODIFIED) continue;
+            uint32_t block = ((uint32_t)tsram_tag(entry) << 9) | ((uint32_t)index << 3);
+            memcpy(&image[block], &sim->cores[core_id].cache.dsram[get_dsram_index(index, 0)],
+                   CACHE_BLOCK_SIZE * sizeof(uint32_t));
+        }
+    }
+}
+
+// Write the Modified lines back to main memory and invalidate every line, for
+// a run that bypasses the caches (--functional) and leaves memory the only copy
+void cache_flush_all(Simulator *sim) {
+    for (int core_id = 0; core_id < NUM_CORES; core_id++) {
+        for (int index = 0; index < NUM_CACHE_BLOCKS; index++) {
+            TSRAMEntry entry = tag_dir_get(&sim->tags, index, core_id);
+            if (tsram_state(entry) == MESI_INVALID) continue;
+            if (tsram_state(entry) == MESI_MODIFIED) {
+                uint32_t block = ((uint32_t)tsram_tag(entry) << 9) | ((uint32_t)index << 3);
+                memcpy(&sim->main_memory.data[block], &sim->cores[core_id].cache.dsram[get_dsram_index(index, 0)],
+                       CACHE_BLOCK_SIZE * sizeof(uint32_t));
+                memory_mark_dirty(&sim->main_memory, block, CACHE_BLOCK_SIZE);
             }
-            // Release stall when block is complete - REMOVED to align with Reference Timing
-            // Stall clears in next cycle's stage_memory() when cache_read() hits
-            // sim->cores[core_id].pipeline.mem.internal_stall = false;
+            tag_dir_set(&sim->tags, index, core_id, tsram_make(tsram_tag(entry), MESI_INVALID));
         }
     }
-}
\ No newline at end of file
+}
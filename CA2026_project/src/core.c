@@ -39,21 +39,6 @@ bool check_data_hazard(Core *core, int reg_index) {
     return false;
 }
 
-// Helper to resolve branch condition
-static bool resolve_branch_condition(Core *core, Instruction inst, int32_t rs_val, int32_t rt_val) {
-    bool take_branch = false;
-    switch (inst.opcode) {
-        case OP_BEQ:  take_branch = (rs_val == rt_val); break;
-        case OP_BNE:  take_branch = (rs_val != rt_val); break;
-        case OP_BLT:  take_branch = (rs_val < rt_val);  break;
-        case OP_BGT:  take_branch = (rs_val > rt_val);  break;
-        case OP_BLE:  take_branch = (rs_val <= rt_val); break;
-        case OP_BGE:  take_branch = (rs_val >= rt_val); break;
-        default: break;
-    }
-    return take_branch;
-}
-
 void stage_fetch(Core* core) {
     if (core->halted || core->halt_fetch) return;
 
@@ -79,7 +64,7 @@ void stage_fetch(Core* core) {
     }
 }
 // Stage 2: Instruction Decode
-void stage_decode(Core* core) {
+void stage_decode(Core* core, Simulator* sim) {
     PipelineReg *dec = &core->pipeline.decode; 
     PipelineReg *fet = &core->pipeline.fetch;
     // 1. Determine if we can accept a new instruction from Fetch
@@ -107,10 +92,15 @@ void stage_decode(Core* core) {
         dec->imm_val = (uint32_t)inst.imm;
 
         // Check for hazards (Check RS and RT)
-        if (check_data_hazard(core, inst.rs) || check_data_hazard(core, inst.rt)) {
+        bool rs_hazard = check_data_hazard(core, inst.rs);
+        if (rs_hazard || check_data_hazard(core, inst.rt)) {
             dec->internal_stall = true; 
             if (!core->pipeline.execute.stall) {
                 core->decode_stall++;
+                PERF_INC(core->perf, rs_hazard ? PERF_DECODE_STALL_RAW_RS : PERF_DECODE_STALL_RAW_RT);
+                if (sim->hotspots.enabled) hotspot_decode_stall(sim, core, rs_hazard ? inst.rs : inst.rt);
+            } else {
+                PERF_INC(core->perf, PERF_DECODE_STALL_EX_BUSY);
             }
             return;
         }
@@ -124,10 +114,19 @@ void stage_decode(Core* core) {
             // Only count as a "Decode Stall" if we aren't already blocked by the Execute stage
             if (!core->pipeline.execute.stall) {
                 core->decode_stall++;
+                PERF_INC(core->perf, PERF_DECODE_STALL_RAW_RD);
+                if (sim->hotspots.enabled) hotspot_decode_stall(sim, core, inst.rd);
+            } else {
+                PERF_INC(core->perf, PERF_DECODE_STALL_EX_BUSY);
             }
             return;
         }
 
+        // No hazard, but the instruction cannot leave ID while EX is held by MEM
+        if (core->pipeline.execute.valid && core->pipeline.execute.stall) {
+            PERF_INC(core->perf, PERF_DECODE_STALL_EX_BUSY);
+        }
+
         // If we get here, the hazard is cleared
         dec->internal_stall = false;
         dec->rs_value = read_register(core, inst.rs, dec->imm_val);
@@ -136,7 +135,7 @@ void stage_decode(Core* core) {
         // 1. Resolve Conditional Branches 
         if (is_branch_instruction(inst)) {
             // Check condition using the values read from registers 
-            if (resolve_branch_condition(core, inst, dec->rs_value, dec->rt_value)) {
+            if (branch_condition(inst.opcode, dec->rs_value, dec->rt_value)) {
                 // PDF: Jump target is R[rd][9:0]
                 uint32_t rd_val = read_register(core, inst.rd, dec->imm_val);
                 core->branch_target = rd_val & 0x3FF;
@@ -192,8 +191,6 @@ void stage_execute(Core *core) {
         Instruction inst = p->execute.inst;
         uint32_t rs_val = p->execute.rs_value;
         uint32_t rt_val = p->execute.rt_value;
-        uint32_t result = 0;
-        bool write_result = false;
         uint32_t sw_data = 0;
 
         if (inst.opcode == OP_SW) {
@@ -202,21 +199,9 @@ void stage_execute(Core *core) {
             sw_data = read_register(core, inst.rd, imm_val); // Read RD (Data)
         }
 
-        switch (inst.opcode) {
-            case OP_ADD: result = rs_val + rt_val; write_result = true; break;
-            case OP_SUB: result = rs_val - rt_val; write_result = true; break;
-            case OP_AND: result = rs_val & rt_val; write_result = true; break;
-            case OP_OR:  result = rs_val | rt_val; write_result = true; break;
-            case OP_XOR: result = rs_val ^ rt_val; write_result = true; break;
-            case OP_MUL: result = rs_val * rt_val; write_result = true; break;
-            case OP_SLL: result = rs_val << (rt_val & 0x1F); write_result = true; break;
-            case OP_SRA: result = (int32_t)rs_val >> (rt_val & 0x1F); write_result = true; break;
-            case OP_SRL: result = rs_val >> (rt_val & 0x1F); write_result = true; break;
-            case OP_JAL: result = (uint32_t)(p->execute.pc + 2); write_result = true; break;
-            case OP_LW: result = rs_val + rt_val; write_result = true; break;
-            case OP_SW: result = rs_val + rt_val; break;
-            default: break;
-        }
+        // ALU ops, JAL and LW write a register; SW, branches and HALT do not
+        uint32_t result = alu_compute(inst.opcode, rs_val, rt_val, p->execute.pc);
+        bool write_result = inst.opcode <= OP_SRL || inst.opcode == OP_JAL || inst.opcode == OP_LW;
 
         p->execute.alu_result = result;
         p->execute.reg_write = write_result;
@@ -225,6 +210,15 @@ void stage_execute(Core *core) {
     }
 }
 
+// Attribute a MEM stall cycle to the bus phase the request is currently in.
+// Runs after bus_cycle(), so the bus state is the one for this cycle.
+CorePerfCounter mem_stall_cause(Simulator *sim, int core_id) {
+    BusArbiter *bus = &sim->bus;
+    if (bus->owner != core_id || bus->state == BUS_STATE_ARBITRATE) return PERF_MEM_STALL_ARBITRATION;
+    if (bus->state == BUS_STATE_FLUSH) return PERF_MEM_STALL_FLUSH;
+    return PERF_MEM_STALL_LATENCY;
+}
+
 // Stage 4: Memory Access
 // Stage 4: Memory Access
 void stage_memory(Core* core, Simulator* sim) {
@@ -244,25 +238,8 @@ void stage_memory(Core* core, Simulator* sim) {
         // --- IMMEDIATE STALL EVALUATION ---
         // We must check for a cache miss the MOMENT the instruction enters MEM.
         // This prevents Write-Back from pulling it out at the start of Cycle T+1.
-        Instruction inst = p->mem.inst;
-        if (inst.opcode == 16 || inst.opcode == 17) { // LW or SW
-            uint32_t addr = p->mem.alu_result;
-            uint8_t index = (addr >> 3) & 0x3F;
-            uint16_t tag = (addr >> 9) & 0xFFF;
-            TSRAMEntry* entry = &core->cache.tsram[index];
-
-            bool hit = (entry->valid && entry->tag == tag && entry->mesi_state != 0);
-
-            // Special case: SW into a Shared block requires a BusRdX (Upgrade), so it's a "Miss"
-            if (inst.opcode == 17 && hit && entry->mesi_state == 1) {
-                hit = false;
-            }
-
-            p->mem.internal_stall = !hit;
-        }
-        else {
-            p->mem.internal_stall = false;
-        }
+        // LW/SW are decided by the access just below (same cycle, same probe).
+        p->mem.internal_stall = false;
     }
 
     // 2. Process instruction currently in MEM
@@ -270,10 +247,24 @@ void stage_memory(Core* core, Simulator* sim) {
         Instruction inst = p->mem.inst;
         if (inst.opcode == 16 || inst.opcode == 17) {
             uint32_t loaded_data;
+            // One directory probe per access; SW into a Shared block is a miss (BusRdX upgrade).
             // This call triggers the actual bus request on the first cycle of a miss
+            MESIState state = tag_lane_state(tag_dir_probe(&sim->tags, p->mem.alu_result), core->core_id);
             bool hit = (inst.opcode == 16) ?
-                cache_read(&core->cache, p->mem.alu_result, &loaded_data, sim, core->core_id) :
-                cache_write(&core->cache, p->mem.alu_result, p->mem.mem_data, sim, core->core_id);
+                cache_read(&core->cache, p->mem.alu_result, state, &loaded_data, sim, core->core_id) :
+                cache_write(&core->cache, p->mem.alu_result, state, p->mem.mem_data, sim, core->core_id);
+
+            if (sim->options.trace.trigger_addr_enabled && !is_retry) {
+                trace_check_addr(sim, p->mem.alu_result);
+            }
+            if (sim->options.miss_classify) {
+                miss_classify_access(sim, core->core_id, p->mem.pc, p->mem.alu_result,
+                                     inst.opcode == 17, hit, !is_retry);
+            }
+            if (sim->memtrace.record) {
+                memtrace_record(sim, core->core_id, inst.opcode == 17, p->mem.alu_result, p->mem.mem_data,
+                                hit, !is_retry);
+            }
 
             // Update Statistics (Only on first attempt)
             if (!is_retry) {
@@ -284,15 +275,31 @@ void stage_memory(Core* core, Simulator* sim) {
                     if (hit) core->write_hit++;
                     else core->write_miss++;
                 }
+                if (!hit && sim->hotspots.enabled) {
+                    hotspot_count(&sim->hotspots, core->core_id, p->mem.pc,
+                                  inst.opcode == 16 ? HOT_READ_MISS : HOT_WRITE_MISS);
+                }
             }
 
             if (hit) {
                 if (inst.opcode == 16) p->mem.mem_data = loaded_data; // Capture data for WB
+                if (sim->sharing.enabled) sharing_access(sim, core->core_id, p->mem.alu_result, inst.opcode == 17);
                 p->mem.internal_stall = false; // Release the stall for next cycle
             }
             else {
                 p->mem.internal_stall = true; // Keep stalling Write-Back
                 core->mem_stall++;
+                PERF_INC(core->perf, mem_stall_cause(sim, core->core_id));
+                if (sim->hotspots.enabled) {
+                    hotspot_count(&sim->hotspots, core->core_id, p->mem.pc, HOT_MEM_STALL);
+                    if (mem_stall_cause(sim, core->core_id) == PERF_MEM_STALL_ARBITRATION) {
+                        hotspot_count(&sim->hotspots, core->core_id, p->mem.pc, HOT_BUS_WAIT);
+                    }
+                }
+                if (sim->hooks.on_miss && !is_retry) {
+                    sim->hooks.on_miss(sim->hooks.user, core->core_id, p->mem.pc, p->mem.alu_result,
+                                       inst.opcode == 17, sim->global_cycle);
+                }
             }
         }
     }
@@ -312,7 +319,8 @@ void stage_writeback(Core *core, Simulator *sim) {
         if (p->mem.inst.opcode == OP_LW) {
             uint32_t fresh_data = 0;
             // Re-read cache (Guaranteed hit if bus just updated it)
-            if (cache_read(&core->cache, p->mem.alu_result, &fresh_data, sim, core->core_id)) {
+            MESIState state = tag_lane_state(tag_dir_probe(&sim->tags, p->mem.alu_result), core->core_id);
+            if (cache_read(&core->cache, p->mem.alu_result, state, &fresh_data, sim, core->core_id)) {
                 p->mem.mem_data = fresh_data;
             }
         }
@@ -337,74 +345,134 @@ void stage_writeback(Core *core, Simulator *sim) {
         }
         
         core->instructions++;
+        if (sim->hotspots.enabled) hotspot_count(&sim->hotspots, core->core_id, p->writeback.pc, HOT_EXEC);
+        if (sim->cosim.enabled) cosim_retire(sim, core, &p->writeback);
+        if (sim->hooks.on_retire) {
+            sim->hooks.on_retire(sim->hooks.user, core->core_id, p->writeback.pc, p->writeback.inst_word, sim->global_cycle);
+        }
     }
 }
 
 // Log detailed cycle trace 
-static void log_cycle_trace(Core *core) {
+void log_cycle_trace(Core *core) {
     if (core->trace_count >= MAX_TRACE_LINES) return;
 
-    char *buffer = core->trace_lines[core->trace_count];
-    int offset = 0;
+    format_cycle_trace(core, core->trace_lines[core->trace_count]);
+    core->trace_count++;
+}
+
+// Format this cycle's trace line (cycle, stage PCs, R2-R15) into buffer
+void format_cycle_trace(Core *core, char *buffer) {
+    CoreTraceRecord rec;
+    capture_cycle_trace(core, &rec);
+    format_core_trace_record(&rec, buffer);
+}
+
+// Snapshot the fields of this cycle's trace line
+void capture_cycle_trace(Core *core, CoreTraceRecord *rec) {
+    Pipeline *p = &core->pipeline;
 
-    offset += sprintf(buffer + offset, "%llu ", core->cycles);
+    rec->cycle = core->cycles;
 
-    if (core->pipeline.fetch.valid) {
-        offset += sprintf(buffer + offset, "%03X ", core->pipeline.fetch.pc);
+    if (p->fetch.valid) {
+        rec->pc[0] = p->fetch.pc;
     } else if (!core->halted && !core->halt_fetch && core->pc < IMEM_SIZE) {
         // Fetch is idle or awaiting targets, show what is pending fetch
-        offset += sprintf(buffer + offset, "%03X ", core->pc);
+        rec->pc[0] = core->pc;
     } else {
-        offset += sprintf(buffer + offset, "--- ");
+        rec->pc[0] = TRACE_NO_PC;
     }
+    rec->pc[1] = p->decode.valid ? p->decode.pc : TRACE_NO_PC;
+    rec->pc[2] = p->execute.valid ? p->execute.pc : TRACE_NO_PC;
+    rec->pc[3] = p->mem.valid ? p->mem.pc : TRACE_NO_PC;
+    rec->pc[4] = p->writeback.valid ? p->writeback.pc : TRACE_NO_PC;
 
-    if (core->pipeline.decode.valid) offset += sprintf(buffer + offset, "%03X ", core->pipeline.decode.pc);
-    else offset += sprintf(buffer + offset, "--- ");
-
-    if (core->pipeline.execute.valid) offset += sprintf(buffer + offset, "%03X ", core->pipeline.execute.pc);
-    else offset += sprintf(buffer + offset, "--- ");
-
-    if (core->pipeline.mem.valid) offset += sprintf(buffer + offset, "%03X ", core->pipeline.mem.pc);
-    else offset += sprintf(buffer + offset, "--- ");
-
-    if (core->pipeline.writeback.valid) offset += sprintf(buffer + offset, "%03X ", core->pipeline.writeback.pc);
-    else offset += sprintf(buffer + offset, "--- ");
-
-    // Registers
+    // Trace logic: R2-R15 values.
+    // Note: R1 is not tracked in the core trace per PDF [cite: 50]
     for (int i = 2; i < NUM_REGISTERS; i++) {
-        // Trace logic: R2-R15 values. 
-        // Note: R1 is not tracked in the core trace per PDF [cite: 50]
-        offset += sprintf(buffer + offset, "%08X ", core->registers[i]);
+        rec->regs[i - 2] = core->registers[i];
     }
-    core->trace_count++;
+}
+
+// "%llu", then "%03X " or "--- " per stage, then "%08X " per register
+void format_core_trace_record(const CoreTraceRecord *rec, char *buffer) {
+    char *p = fmt_u64(buffer, rec->cycle);
+    *p++ = ' ';
+    for (int s = 0; s < 5; s++) {
+        if (rec->pc[s] == TRACE_NO_PC) memcpy(p, "---", 3);
+        else fmt_hex(p, rec->pc[s], 3);
+        p[3] = ' ';
+        p += 4;
+    }
+    for (int i = 0; i < NUM_REGISTERS - 2; i++) {
+        p = fmt_hex(p, rec->regs[i], 8);
+        *p++ = ' ';
+    }
+    *p = '\0';
 }
 
 // Execute one clock cycle
 void execute_core_cycle(Core *core, Simulator *sim) {
     if (core->halted) return;
+    if (sim->spin.enabled && spin_replay_cycle(sim, core)) return;
 
     Pipeline *p = &core->pipeline;
 
     // 1. WB pulls from MEM (from prev cycle)
+    PROFILE_BEGIN(PROF_STAGE_WRITEBACK);
     stage_writeback(core, sim);
+    PROFILE_END(PROF_STAGE_WRITEBACK);
 
     // 2. MEM pulls from EXE (from prev cycle)
+    PROFILE_BEGIN(PROF_STAGE_MEMORY);
     stage_memory(core, sim);
+    PROFILE_END(PROF_STAGE_MEMORY);
 
     // 3. EXE pulls from ID (from prev cycle)
+    PROFILE_BEGIN(PROF_STAGE_EXECUTE);
     stage_execute(core);
+    PROFILE_END(PROF_STAGE_EXECUTE);
 
     // 4. ID pulls from IF (from prev cycle)
-    stage_decode(core);
+    PROFILE_BEGIN(PROF_STAGE_DECODE);
+    stage_decode(core, sim);
+    PROFILE_END(PROF_STAGE_DECODE);
 
     // 5. IF Stage
+    bool fetch_was_valid = p->fetch.valid;
+    PROFILE_BEGIN(PROF_STAGE_FETCH);
     stage_fetch(core);
+    PROFILE_END(PROF_STAGE_FETCH);
+
+    // Breakpoints stop on a new fetch, not on an instruction held in IF by a stall
+    if (sim->breakpoints.count && !fetch_was_valid && p->fetch.valid) {
+        uint16_t pc = p->fetch.pc;
+        if ((sim->breakpoints.mask[core->core_id][pc >> 5] & (1u << (pc & 31))) && !sim->breakpoints.hit) {
+            sim->breakpoints.hit = true;
+            sim->breakpoints.hit_core = core->core_id;
+            sim->breakpoints.hit_pc = pc;
+        }
+    }
+
+    if (sim->options.trace.trigger_pc_enabled && p->fetch.valid) {
+        trace_check_pc(sim, core->core_id, p->fetch.pc);
+    }
 
     // Logging and updates at end of cycle
 
     // Logging and Global updates
     if (!core->halted) {
-        log_cycle_trace(core);
+        if (sim->spin.enabled) spin_capture(sim, core);
+        PROFILE_BEGIN(PROF_CORE_TRACE);
+        if (sim->fingerprint.enabled) {
+            CoreTraceRecord rec;
+            capture_cycle_trace(core, &rec);
+            fingerprint_core(&sim->fingerprint, core->core_id, &rec);
+        } else {
+            char *line = trace_claim_line(sim, core->core_id, core->trace_lines, &core->trace_count, &core->trace_ring);
+            if (line) format_cycle_trace(core, line);
+        }
+        PROFILE_END(PROF_CORE_TRACE);
         
         // Physical Register File update: happens at the END of the clock cycle
         if (core->pending_reg_write_addr >= 2) {
@@ -447,4 +515,6 @@ void execute_core_cycle(Core *core, Simulator *sim) {
             core->halt_fetch = true;
         }
     }
+
+    if (sim->spin.enabled) spin_end_cycle(sim, core);
 }
\ No newline at end of file
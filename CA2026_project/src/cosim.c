@@ -0,0 +1,237 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// LOCKSTEP CO-SIMULATION (--cosim)
+// An ISA-level reference model runs beside the pipeline. Whenever an instruction
+// retires in stage_writeback, the model executes the instruction it expects next
+// and compares the PC, the instruction word, the register write, the load/store
+// address, the store data and the loaded value. The first mismatch is reported
+// with its context and stops the run.
+//
+// The model has its own flat memory image taken before the first cycle (main
+// memory with any warm-started Modified lines over it), and applies stores in
+// retirement order. Conflicting accesses by different cores are always
+// separated by a bus transaction (a core can only read or write a block it
+// holds, and getting it invalidates or flushes the other copies), so
+// retirement order agrees with the bus serialization order recorded in the bus
+// trace. The model shares no code with the pipeline: decoding and execution
+// are written out again here from the ISA definition.
+//
+// Known divergence: the pipeline never writes back a Modified block that a
+// conflict miss replaces, so its stores are lost and a later load reads the
+// older value from memory. The model keeps the stores, and the checker reports
+// that load as a mismatch. inputs/bench/producer_consumer hits this at cycle
+// 8978 (core 1 loads 0 from 0x208, the model expects 0x108). Such a report is
+// the simulator's missing write-back, not a fault in the checker.
+// ====================================================================================
+
+typedef struct {
+    uint32_t inst_word;
+    uint8_t opcode;
+    int dst;                // Register written, -1 if none (writes to R0/R1 are dropped)
+    uint32_t value;
+    bool is_load;
+    bool is_store;
+    uint32_t addr;
+    uint32_t store_data;
+} CosimEffect;
+
+bool cosim_init(CosimChecker *cs) {
+    memset(cs, 0, sizeof(CosimChecker));
+    cs->memory = (uint32_t *)malloc((size_t)MAIN_MEM_SIZE * sizeof(uint32_t));
+    if (!cs->memory) {
+        fprintf(stderr, "Error: Out of memory for the co-simulation model\n");
+        return false;
+    }
+    cs->enabled = true;
+    for (int i = 0; i < NUM_CORES; i++) cs->cores[i].npc = 1;
+    return true;
+}
+
+// Called before the first cycle, after the program and memory image are loaded
+void cosim_start(Simulator *sim) {
+    CosimChecker *cs = &sim->cosim;
+    memcpy(cs->memory, sim->main_memory.data, (size_t)MAIN_MEM_SIZE * sizeof(uint32_t));
+    cache_overlay_modified(sim, cs->memory);
+    cs->started = true;
+}
+
+void cosim_free(CosimChecker *cs) {
+    free(cs->memory);
+    memset(cs, 0, sizeof(CosimChecker));
+}
+
+static uint32_t model_reg(const CosimCore *m, int reg, uint32_t imm) {
+    if (reg == 0) return 0;
+    if (reg == 1) return imm;
+    return m->regs[reg];
+}
+
+// Execute the next instruction of the model without committing it
+static void model_execute(const CosimCore *m, const uint32_t *imem, const uint32_t *memory, CosimEffect *e) {
+    uint32_t w = imem[m->pc];
+    int rd = (w >> 20) & 0xF, rs = (w >> 16) & 0xF, rt = (w >> 12) & 0xF;
+    uint32_t imm = w & 0xFFF;
+    if (imm & 0x800) imm |= 0xFFFFF000;
+    uint32_t a = model_reg(m, rs, imm), b = model_reg(m, rt, imm);
+
+    memset(e, 0, sizeof(CosimEffect));
+    e->inst_word = w;
+    e->opcode = (uint8_t)(w >> 24);
+    e->dst = rd;
+    switch (e->opcode) {
+    case OP_ADD: e->value = a + b; break;
+    case OP_SUB: e->value = a - b; break;
+    case OP_AND: e->value = a & b; break;
+    case OP_OR:  e->value = a | b; break;
+    case OP_XOR: e->value = a ^ b; break;
+    case OP_MUL: e->value = a * b; break;
+    case OP_SLL: e->value = a << (b & 0x1F); break;
+    case OP_SRA: e->value = (uint32_t)((int32_t)a >> (b & 0x1F)); break;
+    case OP_SRL: e->value = a >> (b & 0x1F); break;
+    case OP_JAL:
+        e->dst = 15;
+        e->value = m->pc + 2u;      // Return past the delay slot
+        break;
+    case OP_LW:
+        e->is_load = true;
+        e->addr = a + b;
+        e->value = memory[e->addr & (MAIN_MEM_SIZE - 1)];
+        break;
+    case OP_SW:
+        e->is_store = true;
+        e->addr = a + b;
+        e->store_data = model_reg(m, rd, imm);
+        e->dst = -1;
+        break;
+    default:                        // Branches, HALT, undefined opcodes
+        e->dst = -1;
+        break;
+    }
+    if (e->dst < 2) e->dst = -1;
+}
+
+// Commit the effects and advance the model's PC (one-instruction delay slot)
+static void model_commit(CosimCore *m, const CosimEffect *e, uint32_t *memory) {
+    uint32_t w = e->inst_word;
+    int rd = (w >> 20) & 0xF, rs = (w >> 16) & 0xF, rt = (w >> 12) & 0xF;
+    uint32_t imm = w & 0xFFF;
+    if (imm & 0x800) imm |= 0xFFFFF000;
+    int32_t a = (int32_t)model_reg(m, rs, imm), b = (int32_t)model_reg(m, rt, imm);
+
+    bool taken = false;
+    switch (e->opcode) {
+    case OP_BEQ: taken = a == b; break;
+    case OP_BNE: taken = a != b; break;
+    case OP_BLT: taken = a < b;  break;
+    case OP_BGT: taken = a > b;  break;
+    case OP_BLE: taken = a <= b; break;
+    case OP_BGE: taken = a >= b; break;
+    case OP_JAL: taken = true;   break;
+    default: break;
+    }
+    uint16_t target = (uint16_t)(model_reg(m, rd, imm) & 0x3FF);
+
+    if (e->dst >= 0) m->regs[e->dst] = e->value;
+    if (e->is_store) memory[e->addr & (MAIN_MEM_SIZE - 1)] = e->store_data;
+    if (e->opcode == OP_HALT) m->halted = true;
+
+    m->pc = m->npc;
+    m->npc = taken ? target : (uint16_t)(m->npc + 1);
+    m->retired++;
+}
+
+static void print_regs(const char *label, const uint32_t *regs) {
+    fprintf(stderr, "  %-22s", label);
+    for (int i = 2; i < NUM_REGISTERS; i++) fprintf(stderr, " %08X", regs[i]);
+    fprintf(stderr, "\n");
+}
+
+static void report_mismatch(Simulator *sim, Core *core, const PipelineReg *wb, const CosimEffect *e,
+                            const char *what, uint32_t expected, uint32_t actual) {
+    CosimChecker *cs = &sim->cosim;
+    CosimCore *m = &cs->cores[core->core_id];
+    char text[256];
+
+    fprintf(stderr, "\nCo-simulation mismatch at cycle %llu, core %d: %s\n",
+            (unsigned long long)sim->global_cycle, core->core_id, what);
+    fprintf(stderr, "  expected %08X, pipeline %08X\n", expected, actual);
+
+    print_instruction(decode_instruction(wb->inst_word), text);
+    fprintf(stderr, "  retired    PC %03X  %08X  %s\n", wb->pc, wb->inst_word, text);
+    if (e) {
+        print_instruction(decode_instruction(e->inst_word), text);
+        fprintf(stderr, "  reference  PC %03X  %08X  %s\n", m->pc, e->inst_word, text);
+    }
+    fprintf(stderr, "  instructions retired by this core: %llu (all cores checked: %llu)\n",
+            (unsigned long long)m->retired, (unsigned long long)cs->checked);
+
+    print_regs("reference R2..R15:", m->regs);
+    print_regs("pipeline  R2..R15:", core->registers);
+    format_cycle_trace(core, text);
+    fprintf(stderr, "  pipeline (trace line): %s\n", text);
+
+    if (e && (e->is_load || e->is_store)) {
+        uint32_t addr = e->addr & (MAIN_MEM_SIZE - 1);
+        uint64_t holders = tag_dir_probe(&sim->tags, addr);
+        fprintf(stderr, "  address %06X: reference %08X, main memory %08X, cache states",
+                addr, cs->memory[addr], sim->main_memory.data[addr]);
+        for (int i = 0; i < NUM_CORES; i++) fprintf(stderr, " %d", (int)tag_lane_state(holders, i));
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "  bus: state %d, owner %d, last command %d addr %06X from %d\n",
+            (int)sim->bus.state, sim->bus.owner, (int)sim->bus.current.cmd,
+            sim->bus.current.addr, (int)sim->bus.current.origid);
+    cs->failed = true;
+}
+
+// Check one retiring instruction (p->writeback) against the model
+void cosim_retire(Simulator *sim, Core *core, const PipelineReg *wb) {
+    CosimChecker *cs = &sim->cosim;
+    CosimCore *m = &cs->cores[core->core_id];
+    if (cs->failed) return;
+
+    if (m->halted) {
+        report_mismatch(sim, core, wb, NULL, "instruction retired after HALT", 0, wb->pc);
+        return;
+    }
+    CosimEffect e;
+    model_execute(m, core->imem, cs->memory, &e);
+    cs->checked++;
+
+    if (wb->pc != m->pc) {
+        report_mismatch(sim, core, wb, &e, "PC", m->pc, wb->pc);
+        return;
+    }
+    if (wb->inst_word != e.inst_word) {
+        report_mismatch(sim, core, wb, &e, "instruction word", e.inst_word, wb->inst_word);
+        return;
+    }
+
+    int dst = (wb->reg_write && wb->rw >= 2) ? wb->rw : -1;
+    uint32_t value = (wb->inst.opcode == OP_LW) ? wb->mem_data : wb->alu_result;
+    if (dst != e.dst) {
+        report_mismatch(sim, core, wb, &e, "destination register", (uint32_t)e.dst, (uint32_t)dst);
+        return;
+    }
+    if ((e.is_load || e.is_store) && wb->alu_result != e.addr) {
+        report_mismatch(sim, core, wb, &e, e.is_load ? "load address" : "store address", e.addr, wb->alu_result);
+        return;
+    }
+    if (e.is_store && wb->mem_data != e.store_data) {
+        report_mismatch(sim, core, wb, &e, "store data", e.store_data, wb->mem_data);
+        return;
+    }
+    if (dst >= 0 && value != e.value) {
+        report_mismatch(sim, core, wb, &e, e.is_load ? "loaded value" : "register write value", e.value, value);
+        return;
+    }
+
+    model_commit(m, &e, cs->memory);
+}
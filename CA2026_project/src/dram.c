@@ -0,0 +1,189 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// BANKED DRAM TIMING (--dram)
+// Replaces the fixed MAIN_MEM_LATENCY of a memory-supplied fill with a memory
+// controller model: DRAM_NUM_BANKS banks, each with an open-row buffer and
+// a request queue. A read takes tCAS on a row hit, tRCD + tCAS if the bank is
+// precharged and tRP + tRCD + tCAS on a row conflict, plus any wait for the
+// bank; the bank stays busy for tBURST after the first word. Every tREFI
+// cycles a refresh closes the rows and blocks the banks for tRFC.
+// Writes are the memory updates of cache-to-cache transfers, or with --llc
+// the LLC's dirty evictions and the updates it does not hold. They queue at
+// their bank and are served in the background, ahead of a later read on the
+// same bank; the controller picks row hits first, then the oldest (FR-FCFS).
+// The bus allows one transaction at a time, so a read is the only request
+// that can wait on its result: its latency is resolved when the request is
+// put on the bus, and bus_cycle then counts it down like the fixed latency.
+// Contents still live in MainMemory; only the timing is modeled here.
+// ====================================================================================
+
+static inline uint32_t dram_row(uint32_t addr) {
+    return ((addr & (MAIN_MEM_SIZE - 1)) >> 3) / (DRAM_ROW_BLOCKS * DRAM_NUM_BANKS);
+}
+
+// Bank bits XOR the low row bits, so arrays a multiple of the bank stride
+// apart (every core's copy of a buffer) do not all fall in one bank
+static inline uint32_t dram_bank(uint32_t addr) {
+    return (((addr & (MAIN_MEM_SIZE - 1)) >> 3) / DRAM_ROW_BLOCKS ^ dram_row(addr)) % DRAM_NUM_BANKS;
+}
+
+void dram_init(DramModel *dm) {
+    memset(dm, 0, sizeof(DramModel));
+    for (int b = 0; b < DRAM_NUM_BANKS; b++) {
+        dm->banks[b].open_row = DRAM_NO_ROW;
+        dm->banks[b].next_refresh = DRAM_T_REFI;
+    }
+    dm->enabled = true;
+}
+
+// Refreshes are applied when the bank is next used: one due before start
+// closes the row and keeps the bank busy until it completes
+static uint64_t apply_refresh(DramModel *dm, DramBank *bank, uint64_t start) {
+    while (start >= bank->next_refresh) {
+        uint64_t done = bank->next_refresh + DRAM_T_RFC;
+        if (done > bank->ready) bank->ready = done;
+        bank->open_row = DRAM_NO_ROW;
+        bank->next_refresh += DRAM_T_REFI;
+        if (bank->ready > start) {
+            dm->refresh_delay += bank->ready - start;
+            start = bank->ready;
+        }
+    }
+    return start;
+}
+
+// Serve one request no earlier than start; returns the cycle of its first word
+static uint64_t serve(DramModel *dm, DramBank *bank, const DramRequest *req, uint64_t start) {
+    if (start < bank->ready) start = bank->ready;
+    start = apply_refresh(dm, bank, start);
+
+    uint64_t latency = DRAM_T_CAS;
+    if (bank->open_row == req->row) {
+        dm->row_hits++;
+    } else if (bank->open_row == DRAM_NO_ROW) {
+        latency += DRAM_T_RCD;
+        dm->row_misses++;
+    } else {
+        latency += DRAM_T_RP + DRAM_T_RCD;
+        dm->row_conflicts++;
+    }
+    bank->open_row = req->row;
+    bank->ready = start + latency + DRAM_T_BURST;
+    return start + latency;
+}
+
+// FR-FCFS among the requests that have arrived by now: the oldest row hit, else the oldest
+static int pick(const DramBank *bank, uint64_t now) {
+    int oldest = -1;
+    for (int i = 0; i < bank->count; i++) {
+        if (bank->queue[i].arrival > now) break;       // Queue is in arrival order
+        if (bank->queue[i].row == bank->open_row) return i;
+        if (oldest < 0) oldest = i;
+    }
+    return oldest;
+}
+
+static void dequeue(DramBank *bank, int i) {
+    memmove(&bank->queue[i], &bank->queue[i + 1], (size_t)(bank->count - 1 - i) * sizeof(DramRequest));
+    bank->count--;
+}
+
+// Serve the queued requests the bank could start before cycle until
+static void drain(DramModel *dm, DramBank *bank, uint64_t until) {
+    while (bank->count > 0) {
+        uint64_t start = bank->ready > bank->queue[0].arrival ? bank->ready : bank->queue[0].arrival;
+        if (start >= until) break;
+        int i = pick(bank, start);
+        serve(dm, bank, &bank->queue[i], start);
+        dequeue(bank, i);
+    }
+}
+
+// A block read put on the bus at cycle now: cycles until its first word (at least 1)
+uint32_t dram_read(DramModel *dm, uint32_t addr, uint64_t now) {
+    DramBank *bank = &dm->banks[dram_bank(addr)];
+    drain(dm, bank, now);
+    if (bank->count == DRAM_QUEUE_DEPTH) {
+        serve(dm, bank, &bank->queue[0], now);
+        dequeue(bank, 0);
+    }
+    DramRequest *read = &bank->queue[bank->count++];
+    read->row = dram_row(addr);
+    read->arrival = now;
+    read->is_write = false;
+
+    // Writes ahead of it on the bank go first unless the read hits the open row
+    uint64_t first_word;
+    for (;;) {
+        int i = pick(bank, bank->ready > now ? bank->ready : now);
+        bool done = !bank->queue[i].is_write;
+        uint64_t t = serve(dm, bank, &bank->queue[i], now);
+        dequeue(bank, i);
+        if (done) {
+            first_word = t;
+            break;
+        }
+    }
+
+    uint32_t latency = first_word > now ? (uint32_t)(first_word - now) : 1;
+    dm->reads++;
+    dm->read_latency += latency;
+    if (latency > dm->max_read_latency) dm->max_read_latency = latency;
+    return latency;
+}
+
+// A block written back to memory at cycle now
+void dram_write(DramModel *dm, uint32_t addr, uint64_t now) {
+    DramBank *bank = &dm->banks[dram_bank(addr)];
+    drain(dm, bank, now);
+    if (bank->count == DRAM_QUEUE_DEPTH) {
+        serve(dm, bank, &bank->queue[0], now);
+        dequeue(bank, 0);
+    }
+    DramRequest *write = &bank->queue[bank->count++];
+    write->row = dram_row(addr);
+    write->arrival = now;
+    write->is_write = true;
+    dm->writes++;
+}
+
+static double ratio(uint64_t num, uint64_t den) {
+    return den ? (double)num / (double)den : 0.0;
+}
+
+bool save_dram_stats(const char *filename, Simulator *sim) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    const DramModel *dm = &sim->dram;
+    uint64_t pending = 0;
+    for (int b = 0; b < DRAM_NUM_BANKS; b++) pending += (uint64_t)dm->banks[b].count;
+    uint64_t accesses = dm->row_hits + dm->row_misses + dm->row_conflicts;
+
+    fprintf(fp, "# Banked DRAM: %d banks, %d-block rows; tCAS %d, tRCD %d, tRP %d, burst %d, "
+                "refresh %d every %d cycles\n", DRAM_NUM_BANKS, DRAM_ROW_BLOCKS, DRAM_T_CAS, DRAM_T_RCD,
+            DRAM_T_RP, DRAM_T_BURST, DRAM_T_RFC, DRAM_T_REFI);
+    fprintf(fp, "reads %llu\n", (unsigned long long)dm->reads);
+    fprintf(fp, "writes %llu\n", (unsigned long long)dm->writes);
+    fprintf(fp, "writes_pending %llu\n", (unsigned long long)pending);
+    fprintf(fp, "row_hits %llu\n", (unsigned long long)dm->row_hits);
+    fprintf(fp, "row_misses %llu\n", (unsigned long long)dm->row_misses);
+    fprintf(fp, "row_conflicts %llu\n", (unsigned long long)dm->row_conflicts);
+    fprintf(fp, "row_hit_rate %.4f\n", ratio(dm->row_hits, accesses));
+    fprintf(fp, "avg_read_latency %.2f\n", ratio(dm->read_latency, dm->reads));
+    fprintf(fp, "max_read_latency %llu\n", (unsigned long long)dm->max_read_latency);
+    fprintf(fp, "refresh_delay %llu\n", (unsigned long long)dm->refresh_delay);
+
+    fclose(fp);
+    return true;
+}
@@ -0,0 +1,130 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// TRACE FINGERPRINT (--fingerprint)
+// Each core trace record and bus trace record is hashed field by field instead
+// of being formatted. Every stream (core0..core3, bus) has its own hash. There
+// is one hash for the whole run plus one per checkpoint window of `interval`
+// cycles, so two runs can be compared without writing any trace text, and a
+// mismatch can be narrowed to one window (see scripts/fingerprint_bisect.py).
+// The fields hashed are exactly the ones printed in the trace files.
+// ====================================================================================
+
+#define FP_SEED  0xCBF29CE484222325ULL   // FNV-1a 64-bit offset basis
+#define FP_PRIME 0x100000001B3ULL        // FNV-1a 64-bit prime
+
+// FNV-style step over a whole 64-bit word, with a fold so high bits feed back
+static inline uint64_t fp_mix(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= FP_PRIME;
+    return h ^ (h >> 32);
+}
+
+void fingerprint_init(TraceFingerprint *fp, uint64_t interval) {
+    memset(fp, 0, sizeof(TraceFingerprint));
+    fp->enabled = true;
+    fp->interval = interval ? interval : FINGERPRINT_DEFAULT_INTERVAL;
+    for (int s = 0; s < TRACE_NUM_STREAMS; s++) {
+        fp->window[s] = FP_SEED;
+        fp->total[s] = FP_SEED;
+    }
+}
+
+static void fingerprint_add(TraceFingerprint *fp, int stream, uint64_t h) {
+    fp->window[stream] = fp_mix(fp->window[stream], h);
+    fp->total[stream] = fp_mix(fp->total[stream], h);
+    fp->records[stream]++;
+}
+
+void fingerprint_core(TraceFingerprint *fp, int core_id, const CoreTraceRecord *rec) {
+    uint64_t h = fp_mix(FP_SEED, rec->cycle);
+    h = fp_mix(h, (uint64_t)rec->pc[0] | ((uint64_t)rec->pc[1] << 16) |
+                  ((uint64_t)rec->pc[2] << 32) | ((uint64_t)rec->pc[3] << 48));
+    h = fp_mix(h, rec->pc[4]);
+    for (int i = 0; i < NUM_REGISTERS - 2; i += 2) {
+        h = fp_mix(h, (uint64_t)rec->regs[i] | ((uint64_t)rec->regs[i + 1] << 32));
+    }
+    fingerprint_add(fp, core_id, h);
+}
+
+void fingerprint_bus(TraceFingerprint *fp, uint64_t cycle, const BusTransaction *trans) {
+    // Same fields (and address masking) as format_bus_trace()
+    uint64_t h = fp_mix(FP_SEED, cycle);
+    h = fp_mix(h, (uint64_t)(trans->origid & 0xFF) | ((uint64_t)(trans->cmd & 0xFF) << 8) |
+                  ((uint64_t)(trans->shared ? 1 : 0) << 16) | ((uint64_t)(trans->addr & 0xFFFFF) << 32));
+    h = fp_mix(h, trans->data);
+    fingerprint_add(fp, TRACE_STREAM_BUS, h);
+}
+
+static void fingerprint_checkpoint(TraceFingerprint *fp, uint64_t end_cycle) {
+    if (fp->num_checkpoints == fp->max_checkpoints) {
+        int grow = fp->max_checkpoints ? fp->max_checkpoints * 2 : 256;
+        FingerprintCheckpoint *p = (FingerprintCheckpoint *)realloc(fp->checkpoints, grow * sizeof(FingerprintCheckpoint));
+        if (!p) {
+            fprintf(stderr, "Error: Out of memory for fingerprint checkpoints\n");
+            return;
+        }
+        fp->checkpoints = p;
+        fp->max_checkpoints = grow;
+    }
+
+    FingerprintCheckpoint *cp = &fp->checkpoints[fp->num_checkpoints++];
+    cp->start_cycle = fp->window_start;
+    cp->end_cycle = end_cycle;
+    for (int s = 0; s < TRACE_NUM_STREAMS; s++) {
+        cp->hash[s] = fp->window[s];
+        fp->window[s] = FP_SEED;
+    }
+    fp->window_start = end_cycle + 1;
+}
+
+// Called at the start of every simulated cycle
+void fingerprint_cycle(TraceFingerprint *fp, uint64_t cycle) {
+    if (cycle > 0 && cycle - fp->window_start == fp->interval) {
+        fingerprint_checkpoint(fp, cycle - 1);
+    }
+}
+
+bool save_fingerprint(const char *filename, TraceFingerprint *fp, uint64_t total_cycles) {
+    // Close the final partial window
+    if (total_cycles > fp->window_start) fingerprint_checkpoint(fp, total_cycles - 1);
+
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(out, "# Trace fingerprint: 64-bit hash per stream (core0 core1 core2 core3 bus)\n");
+    fprintf(out, "interval %llu\n", (unsigned long long)fp->interval);
+    fprintf(out, "cycles %llu\n", (unsigned long long)total_cycles);
+    fprintf(out, "records");
+    for (int s = 0; s < TRACE_NUM_STREAMS; s++) fprintf(out, " %llu", (unsigned long long)fp->records[s]);
+    fprintf(out, "\ntotal");
+    for (int s = 0; s < TRACE_NUM_STREAMS; s++) fprintf(out, " %016llX", (unsigned long long)fp->total[s]);
+    fprintf(out, "\n");
+
+    // window <first cycle> <last cycle> <hash per stream>
+    for (int i = 0; i < fp->num_checkpoints; i++) {
+        FingerprintCheckpoint *cp = &fp->checkpoints[i];
+        fprintf(out, "window %llu %llu", (unsigned long long)cp->start_cycle, (unsigned long long)cp->end_cycle);
+        for (int s = 0; s < TRACE_NUM_STREAMS; s++) fprintf(out, " %016llX", (unsigned long long)cp->hash[s]);
+        fprintf(out, "\n");
+    }
+
+    fclose(out);
+    return true;
+}
+
+void fingerprint_free(TraceFingerprint *fp) {
+    free(fp->checkpoints);
+    fp->checkpoints = NULL;
+    fp->num_checkpoints = 0;
+    fp->max_checkpoints = 0;
+}
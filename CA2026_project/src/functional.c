@@ -0,0 +1,307 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// FUNCTIONAL EXECUTION (--functional)
+// Runs the programs at ISA level, without pipeline, caches or bus: for golden
+// results (memout/regout) and for fast-forwarding to a region of interest.
+//
+// Each basic block of a core's IMEM is translated once, the first time it is
+// entered. A block is the straight-line code up to a branch or JAL, plus its
+// delay slot. Translation decodes every instruction into a FuncOp and:
+// - drops instructions without effect (writes to R0/R1, undefined opcodes);
+// - folds ALU ops whose operands are both R0/R1 into one constant write.
+// The opcode semantics are the pipeline's own: alu_compute() and
+// branch_condition() in sim.h, used by stage_execute and stage_decode.
+//
+// Cores take turns of about FUNC_QUANTUM instructions (whole blocks) on the
+// flat main memory. The caches are flushed into it first: a warm start can
+// hold Modified lines newer than memory, and a later timing run must not hit
+// copies the functional stores made stale. Memory ordering between cores is therefore a legal
+// interleaving but not the one the timing model produces; programs that race
+// give different results.
+//
+// IMEM is separate from data memory, so stores cannot modify code. A
+// translation is dropped when its IMEM words are rewritten through simlib
+// (func_invalidate), which is what reloading a program between jobs does.
+// ====================================================================================
+
+#define FUNC_OP_CONST 0xFF              // rd = imm (an ALU op with constant operands)
+
+bool func_init(FuncEngine *fe) {
+    memset(fe, 0, sizeof(FuncEngine));
+    fe->cores = (FuncCore *)calloc(NUM_CORES, sizeof(FuncCore));
+    if (!fe->cores) {
+        fprintf(stderr, "Error: Out of memory for the functional translation cache\n");
+        return false;
+    }
+    fe->enabled = true;
+    return true;
+}
+
+void func_free(FuncEngine *fe) {
+    free(fe->cores);
+    memset(fe, 0, sizeof(FuncEngine));
+}
+
+static void func_flush(FuncEngine *fe, FuncCore *fc) {
+    memset(fc->blocks, 0, sizeof(fc->blocks));
+    memset(fc->translated, 0, sizeof(fc->translated));
+    fc->used_ops = 0;
+    fe->flushes++;
+}
+
+// IMEM words [pc, pc + count) of core_id were rewritten
+void func_invalidate(FuncEngine *fe, int core_id, uint16_t pc, int count) {
+    if (!fe->enabled) return;
+    FuncCore *fc = &fe->cores[core_id];
+    for (int i = pc; i < pc + count && i < IMEM_SIZE; i++) {
+        if (fc->translated[i >> 5] & (1u << (i & 31))) {
+            func_flush(fe, fc);
+            return;
+        }
+    }
+}
+
+// ====================================================================================
+// TRANSLATION
+// ====================================================================================
+
+static bool is_control(Instruction inst) {
+    return is_branch_instruction(inst) || inst.opcode == OP_JAL || inst.opcode == OP_HALT;
+}
+
+// Straight-line instruction -> op. False if it has no architectural effect.
+static bool translate_op(Instruction inst, FuncOp *op) {
+    op->opcode = inst.opcode;
+    op->rd = inst.rd;
+    op->rs = inst.rs;
+    op->rt = inst.rt;
+    op->imm = (uint32_t)(int32_t)inst.imm;
+
+    if (inst.opcode == OP_SW) return true;
+    if (inst.opcode > OP_SRL && inst.opcode != OP_LW) return false;     // Undefined opcodes
+    if (inst.rd < 2) return false;                                      // R0/R1 are not writable
+
+    if (inst.opcode != OP_LW && inst.rs < 2 && inst.rt < 2) {
+        uint32_t a = inst.rs ? op->imm : 0, b = inst.rt ? op->imm : 0;
+        op->imm = alu_compute(inst.opcode, a, b, 0);
+        op->opcode = FUNC_OP_CONST;
+    }
+    return true;
+}
+
+static void mark_translated(FuncCore *fc, uint16_t pc) {
+    fc->translated[pc >> 5] |= 1u << (pc & 31);
+}
+
+static FuncBlock* translate_block(FuncEngine *fe, FuncCore *fc, const uint32_t *imem, uint16_t start) {
+    // A block needs at most one op per instruction
+    if (fc->used_ops + FUNC_MAX_BLOCK_INSTS + 1 > FUNC_POOL_OPS) func_flush(fe, fc);
+
+    FuncBlock *b = &fc->blocks[start];
+    memset(b, 0, sizeof(FuncBlock));
+    b->first = (uint16_t)fc->used_ops;
+    b->end = FUNC_END_FALL;
+
+    uint16_t pc = start;
+    int n = 0;
+    while (pc < IMEM_SIZE && n < FUNC_MAX_BLOCK_INSTS) {
+        Instruction inst = decode_instruction(imem[pc]);
+        mark_translated(fc, pc);
+        pc++;
+        n++;
+
+        if (inst.opcode == OP_HALT) {
+            b->end = FUNC_END_HALT;
+            break;
+        }
+        if (is_control(inst)) {
+            translate_op(inst, &fc->ops[fc->used_ops++]);   // Fills in the branch op; always kept
+            b->end = FUNC_END_BRANCH_SLOW;
+
+            // Delay slot
+            if (pc < IMEM_SIZE) {
+                Instruction slot = decode_instruction(imem[pc]);
+                if (!is_control(slot)) {
+                    mark_translated(fc, pc);
+                    pc++;
+                    n++;
+                    if (translate_op(slot, &fc->ops[fc->used_ops])) {
+                        fc->used_ops++;
+                        b->num_slot = 1;
+                    }
+                    b->end = FUNC_END_BRANCH;
+                }
+            }
+            break;
+        }
+        if (translate_op(inst, &fc->ops[fc->used_ops])) {
+            fc->used_ops++;
+            b->num_body++;
+        }
+    }
+    b->num_insts = (uint8_t)n;
+    b->next_pc = pc;
+    fe->blocks_translated++;
+    return b;
+}
+
+// ====================================================================================
+// EXECUTION
+// ====================================================================================
+
+static void exec_ops(FuncCore *fc, const FuncOp *op, int count, MainMemory *mem) {
+    uint32_t *x = fc->x;
+    for (const FuncOp *end = op + count; op < end; op++) {
+        x[1] = op->imm;
+        switch (op->opcode) {
+        case OP_LW:
+            x[op->rd] = mem->data[(x[op->rs] + x[op->rt]) & (MAIN_MEM_SIZE - 1)];
+            break;
+        case OP_SW: {
+            uint32_t addr = (x[op->rs] + x[op->rt]) & (MAIN_MEM_SIZE - 1);
+            mem->data[addr] = x[op->rd];
+            memory_mark_dirty(mem, addr, 1);
+            break;
+        }
+        case FUNC_OP_CONST:
+            x[op->rd] = op->imm;
+            break;
+        default:
+            x[op->rd] = alu_compute(op->opcode, x[op->rs], x[op->rt], 0);
+            break;
+        }
+    }
+}
+
+// Branch or JAL at pc: the PC after its delay slot (fall if not taken)
+static uint16_t exec_branch(FuncCore *fc, const FuncOp *op, uint16_t pc, uint16_t fall) {
+    uint32_t *x = fc->x;
+    x[1] = op->imm;
+    uint16_t target = (uint16_t)(x[op->rd] & 0x3FF);   // Read before the JAL link write
+    if (op->opcode == OP_JAL) {
+        x[15] = alu_compute(OP_JAL, 0, 0, pc);
+        return target;
+    }
+    return branch_condition(op->opcode, (int32_t)x[op->rs], (int32_t)x[op->rt]) ? target : fall;
+}
+
+// One instruction at pc while a branch is pending (npc != pc + 1)
+static void step_instruction(FuncCore *fc, const uint32_t *imem, MainMemory *mem) {
+    if (fc->pc >= IMEM_SIZE) {
+        fc->stuck = true;
+        return;
+    }
+    Instruction inst = decode_instruction(imem[fc->pc]);
+    uint16_t pc = fc->pc, npc = fc->npc;
+    FuncOp op;
+    fc->retired++;
+
+    if (inst.opcode == OP_HALT) {
+        fc->halted = true;
+        return;
+    }
+    fc->pc = npc;
+    if (is_control(inst)) {
+        translate_op(inst, &op);
+        fc->npc = exec_branch(fc, &op, pc, (uint16_t)(npc + 1));
+    } else {
+        if (translate_op(inst, &op)) exec_ops(fc, &op, 1, mem);
+        fc->npc = (uint16_t)(npc + 1);
+    }
+}
+
+static void run_block(FuncEngine *fe, FuncCore *fc, const uint32_t *imem, MainMemory *mem) {
+    FuncBlock *b = &fc->blocks[fc->pc];
+    if (!b->num_insts) b = translate_block(fe, fc, imem, fc->pc);
+    const FuncOp *ops = &fc->ops[b->first];
+
+    exec_ops(fc, ops, b->num_body, mem);
+    fc->retired += b->num_insts;
+
+    switch (b->end) {
+    case FUNC_END_HALT:
+        fc->halted = true;
+        return;
+    case FUNC_END_BRANCH: {
+        uint16_t bpc = (uint16_t)(b->next_pc - 2);
+        uint16_t to = exec_branch(fc, &ops[b->num_body], bpc, b->next_pc);
+        exec_ops(fc, &ops[b->num_body + 1], b->num_slot, mem);
+        fc->pc = to;
+        break;
+    }
+    case FUNC_END_BRANCH_SLOW: {
+        // The delay slot is stepped on its own next turn
+        uint16_t bpc = (uint16_t)(b->next_pc - 1);
+        fc->pc = b->next_pc;
+        fc->npc = exec_branch(fc, &ops[b->num_body], bpc, (uint16_t)(bpc + 2));
+        return;
+    }
+    default:
+        fc->pc = b->next_pc;
+        break;
+    }
+    fc->npc = (uint16_t)(fc->pc + 1);
+}
+
+// Run every core from its current architectural state (empty pipeline) until
+// all have halted or limit instructions each. Cores are left at an
+// instruction boundary outside any delay slot. True if all halted.
+bool func_run(Simulator *sim, uint64_t limit) {
+    FuncEngine *fe = &sim->func;
+    MainMemory *mem = &sim->main_memory;
+    cache_flush_all(sim);
+
+    for (int i = 0; i < NUM_CORES; i++) {
+        Core *core = &sim->cores[i];
+        FuncCore *fc = &fe->cores[i];
+        memcpy(fc->x, core->registers, sizeof(fc->x));
+        fc->x[0] = 0;
+        fc->pc = core->pc;
+        fc->npc = (uint16_t)(core->pc + 1);
+        fc->halted = core->halted;
+        fc->stuck = false;
+        fc->retired = 0;
+    }
+
+    bool active = true;
+    while (active) {
+        active = false;
+        for (int i = 0; i < NUM_CORES; i++) {
+            FuncCore *fc = &fe->cores[i];
+            if (fc->halted || fc->stuck || fc->retired >= limit) continue;
+            active = true;
+            uint64_t turn_end = fc->retired + FUNC_QUANTUM;
+            if (turn_end > limit) turn_end = limit;
+            while (fc->retired < turn_end && !fc->halted && !fc->stuck) {
+                if (fc->npc != (uint16_t)(fc->pc + 1)) step_instruction(fc, sim->cores[i].imem, mem);
+                else if (fc->pc >= IMEM_SIZE) fc->stuck = true;
+                else run_block(fe, fc, sim->cores[i].imem, mem);
+            }
+        }
+    }
+
+    bool all_halted = true;
+    for (int i = 0; i < NUM_CORES; i++) {
+        Core *core = &sim->cores[i];
+        FuncCore *fc = &fe->cores[i];
+        // Finish a pending delay slot so the PC alone describes the state
+        while (!fc->halted && !fc->stuck && fc->npc != (uint16_t)(fc->pc + 1)) {
+            step_instruction(fc, core->imem, mem);
+        }
+        if (fc->stuck) fprintf(stderr, "Warning: Core %d ran past the end of IMEM without HALT\n", i);
+
+        memcpy(&core->registers[2], &fc->x[2], (NUM_REGISTERS - 2) * sizeof(uint32_t));
+        core->pc = fc->pc;
+        core->halted = fc->halted;
+        core->instructions += fc->retired;
+        if (!fc->halted) all_halted = false;
+    }
+    return all_halted;
+}
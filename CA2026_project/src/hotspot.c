@@ -0,0 +1,129 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// PER-PC HOTSPOT PROFILE (--hotspots)
+// Every stall cycle and miss is charged to the instruction that caused it:
+// - decode stalls to the stalled PC, and to the PC of the producer it waits for
+//   (the youngest instruction in EX/MEM/WB writing the register);
+// - MEM stall cycles, misses and bus-grant waits to the LW/SW in MEM.
+// The counted events are exactly those behind decode_stall, mem_stall,
+// read_miss and write_miss in statsN.txt, so the per-PC sums match the stats.
+// hotspots.txt holds a top-N summary per core and the disassembly listing
+// (save_assembly's format) annotated with every counter.
+// ====================================================================================
+
+#define HOTSPOT_COUNTER_NAME(id, name, desc) name,
+#define HOTSPOT_COUNTER_DESC(id, name, desc) desc,
+
+static const char *HOTSPOT_NAMES[HOT_NUM] = { HOTSPOT_COUNTER_LIST(HOTSPOT_COUNTER_NAME) };
+static const char *HOTSPOT_DESCS[HOT_NUM] = { HOTSPOT_COUNTER_LIST(HOTSPOT_COUNTER_DESC) };
+
+bool hotspot_init(HotspotProfile *hp) {
+    memset(hp, 0, sizeof(HotspotProfile));
+    hp->counts = (uint64_t (*)[IMEM_SIZE][HOT_NUM])calloc(NUM_CORES, sizeof(*hp->counts));
+    if (!hp->counts) {
+        fprintf(stderr, "Error: Out of memory for the hotspot profile\n");
+        return false;
+    }
+    hp->enabled = true;
+    return true;
+}
+
+void hotspot_free(HotspotProfile *hp) {
+    free(hp->counts);
+    memset(hp, 0, sizeof(HotspotProfile));
+}
+
+// A counted decode stall of the instruction in ID, waiting for reg
+void hotspot_decode_stall(Simulator *sim, Core *core, int reg) {
+    Pipeline *p = &core->pipeline;
+    hotspot_count(&sim->hotspots, core->core_id, p->decode.pc, HOT_DECODE_STALL);
+
+    const PipelineReg *producers[3] = { &p->execute, &p->mem, &p->writeback };
+    for (int i = 0; i < 3; i++) {
+        if (producers[i]->valid && producers[i]->reg_write && producers[i]->rw == reg) {
+            hotspot_count(&sim->hotspots, core->core_id, producers[i]->pc, HOT_STALL_CAUSED);
+            return;
+        }
+    }
+}
+
+// Cycles lost at a PC: the ranking key of the summary
+static uint64_t stall_cycles(const uint64_t *c) {
+    return c[HOT_DECODE_STALL] + c[HOT_MEM_STALL];
+}
+
+static void write_counts(FILE *fp, const uint64_t *c) {
+    for (int k = 0; k < HOT_NUM; k++) fprintf(fp, " %9llu", (unsigned long long)c[k]);
+}
+
+static void write_header(FILE *fp, const char *first) {
+    fprintf(fp, "%s", first);
+    for (int k = 0; k < HOT_NUM; k++) fprintf(fp, " %9s", HOTSPOT_NAMES[k]);
+}
+
+bool save_hotspots(const char *filename, Simulator *sim) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "# Hotspot profile, %llu cycles\n", (unsigned long long)sim->global_cycle);
+    for (int k = 0; k < HOT_NUM; k++) fprintf(fp, "# %-8s %s\n", HOTSPOT_NAMES[k], HOTSPOT_DESCS[k]);
+
+    char line[128];
+    for (int i = 0; i < NUM_CORES; i++) {
+        const uint64_t (*counts)[HOT_NUM] = sim->hotspots.counts[i];
+        const uint32_t *imem = sim->cores[i].imem;
+
+        // Top N by stall cycles (selection: N is small)
+        int top[HOTSPOT_TOP_N];
+        int num_top = 0;
+        for (int pc = 0; pc < IMEM_SIZE; pc++) {
+            uint64_t cost = stall_cycles(counts[pc]);
+            if (cost == 0) continue;
+            int pos = num_top;
+            while (pos > 0 && stall_cycles(counts[top[pos - 1]]) < cost) pos--;
+            if (pos == HOTSPOT_TOP_N) continue;
+            if (num_top < HOTSPOT_TOP_N) num_top++;
+            memmove(&top[pos + 1], &top[pos], (size_t)(num_top - 1 - pos) * sizeof(int));
+            top[pos] = pc;
+        }
+
+        fprintf(fp, "\n=== Core %d: top %d PCs by stall cycles (dstall + mstall) ===\n", i, HOTSPOT_TOP_N);
+        write_header(fp, "PC      stall");
+        fprintf(fp, "  instruction\n");
+        for (int t = 0; t < num_top; t++) {
+            format_assembly_line(imem[top[t]], top[t], line);
+            fprintf(fp, "%03X %9llu", top[t], (unsigned long long)stall_cycles(counts[top[t]]));
+            write_counts(fp, counts[top[t]]);
+            fprintf(fp, " %s\n", line + 1);     // Without the listing's leading tab
+        }
+        if (num_top == 0) fprintf(fp, "(no stalls)\n");
+
+        // Listing up to the last non-zero instruction or counted PC
+        int last = -1;
+        for (int pc = 0; pc < IMEM_SIZE; pc++) {
+            if (imem[pc] != 0 || counts[pc][HOT_EXEC] != 0) last = pc;
+        }
+        fprintf(fp, "\n=== Core %d: annotated listing ===\n", i);
+        write_header(fp, "PC ");
+        fprintf(fp, "  instruction\n");
+        for (int pc = 0; pc <= last; pc++) {
+            format_assembly_line(imem[pc], pc, line);
+            fprintf(fp, "%03X", pc);
+            write_counts(fp, counts[pc]);
+            fprintf(fp, " %s\n", line);
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
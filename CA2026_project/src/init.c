@@ -3,12 +3,60 @@
 #include <string.h>
 #include "sim.h"
 
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// The Simulator holds cache-line aligned state, so it gets an aligned allocation.
+// The large buffers come from its arena, mapped here once and reused by every
+// init_simulator() on the same instance.
+Simulator* alloc_simulator(void) {
+#ifdef _WIN32
+    Simulator *sim = (Simulator *)_aligned_malloc(sizeof(Simulator), HOST_CACHE_LINE);
+#else
+    Simulator *sim = NULL;
+    if (posix_memalign((void **)&sim, HOST_CACHE_LINE, sizeof(Simulator)) != 0) sim = NULL;
+#endif
+    if (!sim) return NULL;
+    memset(sim, 0, sizeof(Simulator));
+
+    if (!arena_init(&sim->arena, SIM_ARENA_SIZE)) {
+        free_simulator(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+void free_simulator(Simulator *sim) {
+    if (!sim) return;
+    arena_release(&sim->arena);
+#ifdef _WIN32
+    _aligned_free(sim);
+#else
+    free(sim);
+#endif
+}
+
 void init_simulator(Simulator *sim) {
+    // Keep the arena across the reset and hand out the same slices again.
+    // Main memory keeps its dirty-page map so only written pages are cleared.
+    SimArena arena = sim->arena;
+    MainMemory memory = sim->main_memory;
     memset(sim, 0, sizeof(Simulator));
+    sim->arena = arena;
+    sim->main_memory = memory;
+    arena_reset(&sim->arena);
+
+    for (int i = 0; i < NUM_CORES; i++) {
+        sim->cores[i].trace_lines = (char (*)[TRACE_LINE_SIZE])arena_alloc(&sim->arena, (size_t)MAX_TRACE_LINES * TRACE_LINE_SIZE);
+    }
+    sim->bus.trace_lines = (char (*)[TRACE_LINE_SIZE])arena_alloc(&sim->arena, (size_t)MAX_TRACE_LINES * TRACE_LINE_SIZE);
+    sim->main_memory.data = (uint32_t *)arena_alloc(&sim->arena, (size_t)MAIN_MEM_SIZE * sizeof(uint32_t));
 
     // Initialize all cores
     for (int i = 0; i < NUM_CORES; i++) {
         init_core(&sim->cores[i], i);
+        init_core_tags(&sim->tags, i);
     }
 
     // Initialize main memory
@@ -22,7 +70,9 @@ void init_simulator(Simulator *sim) {
 }
 
 void init_core(Core *core, int core_id) {
+    char (*trace_lines)[TRACE_LINE_SIZE] = core->trace_lines;  // Arena buffer survives the reset
     memset(core, 0, sizeof(Core));
+    core->trace_lines = trace_lines;
 
     core->core_id = core_id;
     core->pc = 0;
@@ -70,12 +120,7 @@ void init_cache(Cache *cache) {
     // Initialize DSRAM (data) to zeros
     memset(cache->dsram, 0, sizeof(cache->dsram));
 
-    // Initialize TSRAM (tag + MESI state)
-    for (int i = 0; i < NUM_CACHE_BLOCKS; i++) {
-        cache->tsram[i].tag = 0;
-        cache->tsram[i].mesi_state = MESI_INVALID;
-        cache->tsram[i].valid = false;
-    }
+    // TSRAM (tag + MESI state) lives in the simulator's TagDirectory, see init_core_tags()
 
     cache->state = CACHE_IDLE;
     cache->pending_addr = 0;
@@ -84,11 +129,27 @@ void init_cache(Cache *cache) {
     cache->words_sent = 0;
 }
 
+// Reset one core's TSRAM lane (tag 0, Invalid) in every set
+void init_core_tags(TagDirectory *tags, int core_id) {
+    for (int i = 0; i < NUM_CACHE_BLOCKS; i++) {
+        tag_dir_set(tags, i, core_id, tsram_make(0, MESI_INVALID));
+    }
+}
+
 void init_main_memory(MainMemory *mem) {
+    uint32_t *data = mem->data;  // Arena buffer survives the reset
+    uint64_t dirty[MEM_NUM_PAGES / 64];
+    memcpy(dirty, mem->dirty, sizeof(dirty));
     memset(mem, 0, sizeof(MainMemory));
-
-    // Initialize all memory to zeros
-    memset(mem->data, 0, sizeof(mem->data));
+    mem->data = data;
+
+    // Zero only the pages written since the last reset; the rest are still
+    // zero (a fresh arena mapping is zero-filled)
+    for (uint32_t p = 0; p < MEM_NUM_PAGES; p++) {
+        if (dirty[p >> 6] & (1ULL << (p & 63))) {
+            memset(&mem->data[(size_t)p * MEM_PAGE_WORDS], 0, MEM_PAGE_WORDS * sizeof(uint32_t));
+        }
+    }
 
     mem->pending = false;
     mem->cycles_remaining = 0;
@@ -96,7 +157,9 @@ void init_main_memory(MainMemory *mem) {
 }
 
 void init_bus_arbiter(BusArbiter *bus) {
+    char (*trace_lines)[TRACE_LINE_SIZE] = bus->trace_lines;  // Arena buffer survives the reset
     memset(bus, 0, sizeof(BusArbiter));
+    bus->trace_lines = trace_lines;
 
     // Initialize current transaction to no command
     bus->current.origid = 0;
@@ -112,6 +175,7 @@ void init_bus_arbiter(BusArbiter *bus) {
     bus->provider_id = 4;
     bus->upgrade_only = false;
     bus->words_transferred = 0;
+    bus->starvation_threshold = BUS_STARVATION_THRESHOLD;
 
     // No pending transactions
     for (int i = 0; i < NUM_CORES; i++) {
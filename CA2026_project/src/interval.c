@@ -0,0 +1,130 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// INTERVAL STATISTICS (--interval N)
+// Every N cycles the cumulative counters of statsN.txt and the bus busy cycles
+// by transaction type are copied into a sample (a fixed-size copy, so the
+// overhead is constant per interval). intervals.csv holds one row per
+// interval with the differences: per core IPC, miss rates and stall cycles,
+// then the bus cycles by command and the bus utilization.
+// Bus cycles are counted from the grant, so a transaction spanning a sample
+// is split between the two intervals.
+// ====================================================================================
+
+bool interval_init(IntervalStats *iv, uint64_t length) {
+    memset(iv, 0, sizeof(IntervalStats));
+    iv->capacity = 256;
+    iv->samples = (IntervalSample *)calloc((size_t)iv->capacity, sizeof(IntervalSample));
+    if (!iv->samples) {
+        fprintf(stderr, "Error: Out of memory for interval statistics\n");
+        return false;
+    }
+    iv->count = 1;                  // The run starts with every counter at zero
+    iv->length = length;
+    iv->next = length;
+    iv->enabled = true;
+    return true;
+}
+
+void interval_free(IntervalStats *iv) {
+    free(iv->samples);
+    memset(iv, 0, sizeof(IntervalStats));
+}
+
+// Record every counter as of the current cycle
+void interval_snapshot(Simulator *sim) {
+    IntervalStats *iv = &sim->intervals;
+    iv->next = sim->global_cycle + iv->length;
+    if (iv->count == iv->capacity) {
+        IntervalSample *p = (IntervalSample *)realloc(iv->samples, (size_t)iv->capacity * 2 * sizeof(IntervalSample));
+        if (!p) {
+            fprintf(stderr, "Error: Out of memory for interval statistics\n");
+            return;
+        }
+        iv->samples = p;
+        iv->capacity *= 2;
+    }
+
+    // Parked spin loops keep their counters behind until settled
+    spin_sync(sim);
+
+    IntervalSample *s = &iv->samples[iv->count++];
+    s->cycle = sim->global_cycle;
+    for (int i = 0; i < NUM_CORES; i++) {
+        const Core *core = &sim->cores[i];
+        s->core[i][IV_CYCLES] = core->cycles;
+        s->core[i][IV_INSTRUCTIONS] = core->instructions;
+        s->core[i][IV_READ_HIT] = core->read_hit;
+        s->core[i][IV_WRITE_HIT] = core->write_hit;
+        s->core[i][IV_READ_MISS] = core->read_miss;
+        s->core[i][IV_WRITE_MISS] = core->write_miss;
+        s->core[i][IV_DECODE_STALL] = core->decode_stall;
+        s->core[i][IV_MEM_STALL] = core->mem_stall;
+    }
+
+    // Completed transactions, plus the one on the bus once its supplier is known
+    const BusArbiter *bus = &sim->bus;
+    memcpy(s->bus, bus->util_cycles, sizeof(s->bus));
+    if (bus->owner >= 0 && bus->state != BUS_STATE_IDLE && bus->state != BUS_STATE_ARBITRATE) {
+        bool c2c = bus->provider_id != 4;
+        BusUtilType type = (bus->pending_trans[bus->owner].cmd == BUS_RD)
+            ? (c2c ? BUS_UTIL_RD_C2C : BUS_UTIL_RD_MEM)
+            : (c2c ? BUS_UTIL_RDX_C2C : BUS_UTIL_RDX_MEM);
+        s->bus[type] += sim->global_cycle - bus->grant_time;
+    }
+}
+
+static double ratio(uint64_t num, uint64_t den) {
+    return den ? (double)num / (double)den : 0.0;
+}
+
+bool save_interval_stats(const char *filename, Simulator *sim) {
+    IntervalStats *iv = &sim->intervals;
+    if (sim->global_cycle > iv->samples[iv->count - 1].cycle) interval_snapshot(sim);   // Last, partial interval
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "start,end");
+    for (int i = 0; i < NUM_CORES; i++) {
+        fprintf(fp, ",core%d_instructions,core%d_ipc,core%d_read_miss_rate,core%d_write_miss_rate,"
+                    "core%d_decode_stall,core%d_mem_stall", i, i, i, i, i, i);
+    }
+    fprintf(fp, ",bus_rd_memory,bus_rd_cache,bus_rdx_memory,bus_rdx_cache,bus_utilization\n");
+
+    for (int k = 1; k < iv->count; k++) {
+        const IntervalSample *a = &iv->samples[k - 1], *b = &iv->samples[k];
+        uint64_t cycles = b->cycle - a->cycle;
+        fprintf(fp, "%llu,%llu", (unsigned long long)a->cycle, (unsigned long long)b->cycle);
+
+        for (int i = 0; i < NUM_CORES; i++) {
+            uint64_t d[IV_CORE_COUNTERS];
+            for (int c = 0; c < IV_CORE_COUNTERS; c++) d[c] = b->core[i][c] - a->core[i][c];
+            fprintf(fp, ",%llu,%.4f,%.4f,%.4f,%llu,%llu", (unsigned long long)d[IV_INSTRUCTIONS],
+                    ratio(d[IV_INSTRUCTIONS], d[IV_CYCLES]),
+                    ratio(d[IV_READ_MISS], d[IV_READ_HIT] + d[IV_READ_MISS]),
+                    ratio(d[IV_WRITE_MISS], d[IV_WRITE_HIT] + d[IV_WRITE_MISS]),
+                    (unsigned long long)d[IV_DECODE_STALL], (unsigned long long)d[IV_MEM_STALL]);
+        }
+
+        uint64_t busy = 0;
+        for (int t = 0; t < BUS_UTIL_NUM; t++) {
+            uint64_t d = b->bus[t] - a->bus[t];
+            busy += d;
+            fprintf(fp, ",%llu", (unsigned long long)d);
+        }
+        fprintf(fp, ",%.4f\n", ratio(busy, cycles));
+    }
+
+    fclose(fp);
+    return true;
+}
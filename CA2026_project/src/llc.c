@@ -0,0 +1,243 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// SHARED LAST-LEVEL CACHE (--llc WORDS)
+// A set-associative LRU cache of memory blocks between the bus and main
+// memory. A memory-supplied BusRd/BusRdX that hits delivers its first word
+// after --llc-latency cycles instead of MAIN_MEM_LATENCY (or the --dram
+// model's latency); a cache-to-cache transfer bypasses it for the data, and
+// its memory update writes the LLC copy if present. The inclusion policy
+// decides what is filled:
+// - inclusive: every memory read fills; evicting a block invalidates its
+//   clean L1 copies (a Modified copy stays: it has nowhere to go);
+// - non-inclusive: every memory read fills, evictions leave the L1s alone;
+// - exclusive: memory reads do not fill, a hit moves the block to the L1, and
+//   a block an L1 replaces is filled unless another L1 still holds it.
+// The L1s have no write-back path in this simulator (a replaced Modified
+// block's data is dropped), and no policy adds one: the LLC changes timing
+// only, so every configuration computes the same results as without it. The
+// LLC copy always equals main memory, which stays the source of the data;
+// dirty marks blocks whose DRAM copy would be stale (a memory update, or the
+// write-back a Modified exclusive victim would make), for --dram's traffic.
+// ====================================================================================
+
+static const char *LLC_POLICY_NAMES[] = { "inclusive", "non-inclusive", "exclusive" };
+
+bool llc_init(SharedLLC *llc, const SimOptions *options) {
+    memset(llc, 0, sizeof(SharedLLC));
+    uint32_t blocks = options->llc_size / CACHE_BLOCK_SIZE;
+    int ways = options->llc_ways;
+    if (ways < 1 || options->llc_size % CACHE_BLOCK_SIZE || blocks % (uint32_t)ways ||
+        options->llc_size > MAIN_MEM_SIZE) {
+        fprintf(stderr, "Error: LLC of %u words does not hold a whole number of %d-way sets of %d-word blocks\n",
+                options->llc_size, ways, CACHE_BLOCK_SIZE);
+        return false;
+    }
+    if (options->llc_latency < 1) {
+        fprintf(stderr, "Error: LLC latency must be at least 1 cycle\n");
+        return false;
+    }
+
+    llc->sets = blocks / (uint32_t)ways;
+    llc->ways = ways;
+    llc->latency = options->llc_latency;
+    llc->policy = options->llc_policy;
+    llc->lines = (LLCLine *)calloc(blocks, sizeof(LLCLine));
+    llc->data = (uint32_t *)calloc(options->llc_size, sizeof(uint32_t));
+    if (!llc->lines || !llc->data) {
+        fprintf(stderr, "Error: Out of memory for the LLC\n");
+        llc_free(llc);
+        return false;
+    }
+    llc->enabled = true;
+    return true;
+}
+
+void llc_free(SharedLLC *llc) {
+    free(llc->lines);
+    free(llc->data);
+    memset(llc, 0, sizeof(SharedLLC));
+}
+
+static inline uint32_t llc_block(uint32_t addr) {
+    return (addr & (MAIN_MEM_SIZE - 1)) >> 3;
+}
+
+static LLCLine* llc_lookup(SharedLLC *llc, uint32_t block) {
+    LLCLine *set = &llc->lines[(block % llc->sets) * (uint32_t)llc->ways];
+    for (int w = 0; w < llc->ways; w++) {
+        if (set[w].valid && set[w].block == block) return &set[w];
+    }
+    return NULL;
+}
+
+static inline uint32_t* line_data(SharedLLC *llc, const LLCLine *line) {
+    return &llc->data[(size_t)(line - llc->lines) * CACHE_BLOCK_SIZE];
+}
+
+// The line's block leaves the LLC: a dirty one goes to DRAM
+static void llc_drop(Simulator *sim, LLCLine *line) {
+    SharedLLC *llc = &sim->llc;
+    if (line->dirty) {
+        llc->writebacks++;
+        if (sim->dram.enabled) dram_write(&sim->dram, line->block << 3, sim->global_cycle);
+    }
+    line->valid = false;
+    line->dirty = false;
+}
+
+// Inclusion: invalidate every clean L1 copy of the evicted block. A Modified
+// copy is kept, since invalidating it would drop its data before the L1 does.
+static void back_invalidate(Simulator *sim, LLCLine *victim) {
+    uint32_t block_addr = victim->block << 3;
+    uint8_t index = (uint8_t)(victim->block & 0x3F);
+    uint64_t holders = tag_dir_probe(&sim->tags, block_addr);
+    for (int i = 0; i < NUM_CORES; i++) {
+        MESIState state = tag_lane_state(holders, i);
+        if (state == MESI_INVALID || state == MESI_MODIFIED) continue;
+        if (sim->spin.enabled) spin_snoop(sim, i, block_addr, true);
+        tag_dir_set(&sim->tags, index, i, tsram_make(tsram_tag(tag_dir_get(&sim->tags, index, i)), MESI_INVALID));
+        sim->llc.back_invalidations++;
+    }
+}
+
+// Place block (data from main memory), evicting the set's LRU line if full
+static void llc_fill(Simulator *sim, uint32_t block, bool dirty) {
+    SharedLLC *llc = &sim->llc;
+    LLCLine *set = &llc->lines[(block % llc->sets) * (uint32_t)llc->ways];
+    LLCLine *line = &set[0];
+    for (int w = 0; w < llc->ways; w++) {
+        if (!set[w].valid) {
+            line = &set[w];
+            break;
+        }
+        if (set[w].last_use < line->last_use) line = &set[w];
+    }
+    if (line->valid) {
+        llc->evictions++;
+        if (llc->policy == LLC_INCLUSIVE) back_invalidate(sim, line);
+        llc_drop(sim, line);
+    }
+    line->block = block;
+    line->valid = true;
+    line->dirty = dirty;
+    line->last_use = ++llc->stamp;
+    memcpy(line_data(llc, line), &sim->main_memory.data[block << 3], CACHE_BLOCK_SIZE * sizeof(uint32_t));
+    llc->fills++;
+}
+
+// A memory-supplied bus read of addr: cycles from the request to its first word
+int llc_read(Simulator *sim, uint32_t addr) {
+    SharedLLC *llc = &sim->llc;
+    uint32_t block = llc_block(addr);
+    LLCLine *line = llc_lookup(llc, block);
+    if (line) {
+        llc->read_hit++;
+        line->last_use = ++llc->stamp;
+        if (llc->policy == LLC_EXCLUSIVE) llc_drop(sim, line);
+        return llc->latency;
+    }
+
+    llc->read_miss++;
+    int latency = sim->dram.enabled ? (int)dram_read(&sim->dram, addr, sim->global_cycle) : MAIN_MEM_LATENCY;
+    if (llc->policy != LLC_EXCLUSIVE) llc_fill(sim, block, false);
+    return latency;
+}
+
+// The memory update of a cache-to-cache transfer; false if it goes on to DRAM
+bool llc_write(Simulator *sim, uint32_t block_addr) {
+    SharedLLC *llc = &sim->llc;
+    LLCLine *line = llc_lookup(llc, llc_block(block_addr));
+    if (!line) {
+        llc->write_miss++;
+        return false;
+    }
+    llc->write_hit++;
+    line->dirty = true;
+    line->last_use = ++llc->stamp;
+    memcpy(line_data(llc, line), &sim->main_memory.data[line->block << 3], CACHE_BLOCK_SIZE * sizeof(uint32_t));
+    return true;
+}
+
+// core_id's fill of block_addr is about to replace its copy of another block
+void llc_l1_victim(Simulator *sim, int core_id, uint32_t block_addr) {
+    if (sim->llc.policy != LLC_EXCLUSIVE) return;
+    uint8_t index = (uint8_t)((block_addr >> 3) & 0x3F);
+    TSRAMEntry entry = tag_dir_get(&sim->tags, index, core_id);
+    MESIState state = tsram_state(entry);
+    uint32_t victim = ((uint32_t)tsram_tag(entry) << 9) | ((uint32_t)index << 3);
+    if (state == MESI_INVALID || victim == (block_addr & ~0x7u)) return;
+
+    uint64_t holders = tag_dir_probe(&sim->tags, victim);
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (i != core_id && tag_lane_state(holders, i) != MESI_INVALID) return;
+    }
+    if (llc_lookup(&sim->llc, llc_block(victim))) return;
+    // From memory: a Modified victim's stores are dropped, as on every L1 replacement
+    llc_fill(sim, llc_block(victim), state == MESI_MODIFIED);
+    sim->llc.victim_fills++;
+}
+
+// ====================================================================================
+// OUTPUT FILES
+// ====================================================================================
+
+static bool open_llc_output(const char *filename, OutBuf *ob) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp || !outbuf_open(ob, fp)) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        if (fp) fclose(fp);
+        return false;
+    }
+    return true;
+}
+
+// statsN.txt format, plus the configuration
+bool save_llc_stats(const char *filename, SharedLLC *llc) {
+    OutBuf ob;
+    if (!open_llc_output(filename, &ob)) return false;
+
+    char line[96];
+    sprintf(line, "# %u words, %u sets x %d ways, latency %d, %s\n", llc->sets * (uint32_t)llc->ways * CACHE_BLOCK_SIZE,
+            llc->sets, llc->ways, llc->latency, LLC_POLICY_NAMES[llc->policy]);
+    outbuf_write(&ob, line, strlen(line));
+    outbuf_stat_line(&ob, "read_hit", llc->read_hit);
+    outbuf_stat_line(&ob, "read_miss", llc->read_miss);
+    outbuf_stat_line(&ob, "write_hit", llc->write_hit);
+    outbuf_stat_line(&ob, "write_miss", llc->write_miss);
+    outbuf_stat_line(&ob, "fills", llc->fills);
+    outbuf_stat_line(&ob, "victim_fills", llc->victim_fills);
+    outbuf_stat_line(&ob, "evictions", llc->evictions);
+    outbuf_stat_line(&ob, "writebacks", llc->writebacks);
+    outbuf_stat_line(&ob, "back_invalidations", llc->back_invalidations);
+    return outbuf_close(&ob);
+}
+
+// dsramN.txt format: every line's words, set by set and way by way
+bool save_llc_dsram(const char *filename, SharedLLC *llc) {
+    OutBuf ob;
+    if (!open_llc_output(filename, &ob)) return false;
+    size_t words = (size_t)llc->sets * (size_t)llc->ways * CACHE_BLOCK_SIZE;
+    for (size_t i = 0; i < words; i++) outbuf_hex_line(&ob, llc->data[i]);
+    return outbuf_close(&ob);
+}
+
+// tsramN.txt counterpart, one entry per line: bit 31 valid, bit 30 dirty,
+// low bits the tag (block number / sets)
+bool save_llc_tsram(const char *filename, SharedLLC *llc) {
+    OutBuf ob;
+    if (!open_llc_output(filename, &ob)) return false;
+    uint32_t lines = llc->sets * (uint32_t)llc->ways;
+    for (uint32_t i = 0; i < lines; i++) {
+        const LLCLine *line = &llc->lines[i];
+        uint32_t entry = line->valid ? (0x80000000u | (line->dirty ? 0x40000000u : 0) | line->block / llc->sets) : 0;
+        outbuf_hex_line(&ob, entry);
+    }
+    return outbuf_close(&ob);
+}
@@ -1,11 +1,17 @@
 // Disable MSVC security warnings for standard C functions
 #define _CRT_SECURE_NO_WARNINGS
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef _WIN32
 #include <direct.h>  // for _getcwd
-#include "sim.h"
+#define getcwd _getcwd
+#else
+#include <unistd.h>  // for getcwd
+#endif
+#include "simlib.h"
 
 // Default file names (27 total)
 // Inputs from ../inputs/
@@ -26,15 +32,269 @@ static const char *DEFAULT_FILES[27] = {
 
 #define NUM_FILES 27
 
+// --trace LIST: comma-separated core0..core3, bus, all, none. Unlisted streams are disabled.
+static bool parse_trace_streams(const char *list, uint32_t *disabled) {
+    char buf[128];
+    uint32_t enabled = 0;
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        if (strcmp(tok, "all") == 0) enabled = (1u << TRACE_NUM_STREAMS) - 1;
+        else if (strcmp(tok, "none") == 0) enabled = 0;
+        else if (strcmp(tok, "bus") == 0) enabled |= 1u << TRACE_STREAM_BUS;
+        else if (strncmp(tok, "core", 4) == 0 && tok[4] >= '0' && tok[4] < '0' + NUM_CORES && !tok[5])
+            enabled |= 1u << (tok[4] - '0');
+        else return false;
+    }
+    *disabled = ~enabled & ((1u << TRACE_NUM_STREAMS) - 1);
+    return true;
+}
+
+// --trace-window A:B (inclusive cycles)
+static bool parse_trace_window(const char *arg, TraceConfig *cfg) {
+    unsigned long long start, end;
+    if (cfg->num_windows >= MAX_TRACE_WINDOWS) return false;
+    if (sscanf(arg, "%llu:%llu", &start, &end) != 2 || end < start) return false;
+    cfg->windows[cfg->num_windows].start = start;
+    cfg->windows[cfg->num_windows].end = end;
+    cfg->num_windows++;
+    return true;
+}
+
+// --trace-trigger-pc [CORE:]PC (PC in hex, as printed in the core traces)
+static bool parse_trace_trigger_pc(const char *arg, TraceConfig *cfg) {
+    unsigned int core, pc;
+    if (sscanf(arg, "%u:%x", &core, &pc) == 2) {
+        if (core >= NUM_CORES) return false;
+        cfg->trigger_pc_core = (int)core;
+    } else if (sscanf(arg, "%x", &pc) == 1) {
+        cfg->trigger_pc_core = -1;
+    } else {
+        return false;
+    }
+    if (pc >= IMEM_SIZE) return false;
+    cfg->trigger_pc = (uint16_t)pc;
+    cfg->trigger_pc_enabled = true;
+    return true;
+}
+
+// --trace-trigger-addr ADDR (hex word address, as printed in the bus trace)
+static bool parse_trace_trigger_addr(const char *arg, TraceConfig *cfg) {
+    char *end;
+    unsigned long addr = strtoul(arg, &end, 16);
+    if (end == arg || *end != '\0' || addr >= MAIN_MEM_SIZE) return false;
+    cfg->trigger_addr = (uint32_t)addr;
+    cfg->trigger_addr_enabled = true;
+    return true;
+}
+
+// Decimal value of a numeric option, in [min, max]. Anything else (sign,
+// trailing characters, overflow) is reported and rejected.
+static bool parse_number(const char *option, const char *arg, uint64_t min, uint64_t max, uint64_t *value) {
+    char *end;
+    errno = 0;
+    unsigned long long v = strtoull(arg, &end, 10);
+    if (arg[0] < '0' || arg[0] > '9' || *end != '\0' || errno == ERANGE || v < min || v > max) {
+        if (max == UINT64_MAX) fprintf(stderr, "Error: Bad %s %s (at least %llu)\n", option, arg, (unsigned long long)min);
+        else fprintf(stderr, "Error: Bad %s %s (%llu-%llu)\n", option, arg, (unsigned long long)min, (unsigned long long)max);
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+// Strip "--option" arguments out of argv. Remaining positional arguments are
+// compacted into args[] (args[0] = program name) and counted in *nargs.
+static bool parse_options(int argc, char *argv[], SimOptions *opts, char **args, int *nargs) {
+    simlib_default_options(opts);
+    *nargs = 0;
 
+    for (int i = 0; i < argc; i++) {
+        if (i == 0 || strncmp(argv[i], "--", 2) != 0) {
+            args[(*nargs)++] = argv[i];
+        } else if (strcmp(argv[i], "--miss-classify") == 0) {
+            opts->miss_classify = true;
+        } else if (strcmp(argv[i], "--hotspots") == 0) {
+            opts->hotspots = true;
+        } else if (strcmp(argv[i], "--sharing-report") == 0) {
+            opts->sharing_report = true;
+        } else if (strcmp(argv[i], "--timeline") == 0 && i + 1 < argc) {
+            opts->timeline_file = argv[++i];
+        } else if (strcmp(argv[i], "--record-mem") == 0 && i + 1 < argc) {
+            opts->record_mem = argv[++i];
+        } else if (strcmp(argv[i], "--replay-mem") == 0 && i + 1 < argc) {
+            opts->replay_mem = argv[++i];
+        } else if (strcmp(argv[i], "--dram") == 0) {
+            opts->dram = true;
+        } else if (strcmp(argv[i], "--llc") == 0 && i + 1 < argc) {
+            uint64_t words;
+            if (!parse_number(argv[i], argv[i + 1], 1, MAIN_MEM_SIZE, &words)) return false;
+            i++;
+            opts->llc_size = (uint32_t)words;
+        } else if (strcmp(argv[i], "--llc-ways") == 0 && i + 1 < argc) {
+            uint64_t ways;
+            if (!parse_number(argv[i], argv[i + 1], 1, MAIN_MEM_SIZE / CACHE_BLOCK_SIZE, &ways)) return false;
+            i++;
+            opts->llc_ways = (int)ways;
+        } else if (strcmp(argv[i], "--llc-latency") == 0 && i + 1 < argc) {
+            uint64_t cycles;
+            if (!parse_number(argv[i], argv[i + 1], 1, INT32_MAX, &cycles)) return false;
+            i++;
+            opts->llc_latency = (int)cycles;
+        } else if (strcmp(argv[i], "--llc-policy") == 0 && i + 1 < argc) {
+            const char *policy = argv[++i];
+            if (strcmp(policy, "inclusive") == 0) opts->llc_policy = LLC_INCLUSIVE;
+            else if (strcmp(policy, "non-inclusive") == 0) opts->llc_policy = LLC_NON_INCLUSIVE;
+            else if (strcmp(policy, "exclusive") == 0) opts->llc_policy = LLC_EXCLUSIVE;
+            else {
+                fprintf(stderr, "Error: Bad --llc-policy %s (inclusive, non-inclusive or exclusive)\n", policy);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            if (!parse_number(argv[i], argv[i + 1], 1, UINT64_MAX, &opts->interval)) return false;
+            i++;
+        } else if (strcmp(argv[i], "--self-profile") == 0) {
+            opts->self_profile = true;
+        } else if (strcmp(argv[i], "--starvation-threshold") == 0 && i + 1 < argc) {
+            if (!parse_number(argv[i], argv[i + 1], 1, UINT64_MAX, &opts->starvation_threshold)) return false;
+            i++;
+        } else if (strcmp(argv[i], "--output-threads") == 0 && i + 1 < argc) {
+            uint64_t threads;
+            if (!parse_number(argv[i], argv[i + 1], 1, OUTPUT_MAX_THREADS, &threads)) return false;
+            i++;
+            opts->output_threads = (int)threads;
+        } else if (strcmp(argv[i], "--fingerprint") == 0 && i + 1 < argc) {
+            opts->fingerprint_file = argv[++i];
+        } else if (strcmp(argv[i], "--fingerprint-interval") == 0 && i + 1 < argc) {
+            if (!parse_number(argv[i], argv[i + 1], 1, UINT64_MAX, &opts->fingerprint_interval)) return false;
+            i++;
+        } else if (strcmp(argv[i], "--spin-ff") == 0) {
+            opts->spin_ff = true;
+        } else if (strcmp(argv[i], "--warm-start") == 0 && i + 1 < argc) {
+            opts->warm_start = argv[++i];
+        } else if (strcmp(argv[i], "--functional") == 0) {
+            opts->functional = true;
+        } else if (strcmp(argv[i], "--cosim") == 0) {
+            opts->cosim = true;
+        } else if (strcmp(argv[i], "--server") == 0) {
+            opts->server = true;
+        } else if (strcmp(argv[i], "--server-socket") == 0 && i + 1 < argc) {
+            opts->server = true;
+            opts->server_socket = argv[++i];
+        } else if (strcmp(argv[i], "--no-trace") == 0) {
+            opts->trace.disabled_streams = (1u << TRACE_NUM_STREAMS) - 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if (!parse_trace_streams(argv[++i], &opts->trace.disabled_streams)) {
+                fprintf(stderr, "Error: Bad --trace list %s\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--trace-window") == 0 && i + 1 < argc) {
+            if (!parse_trace_window(argv[++i], &opts->trace)) {
+                fprintf(stderr, "Error: Bad --trace-window %s (A:B, at most %d windows)\n", argv[i], MAX_TRACE_WINDOWS);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--trace-trigger-pc") == 0 && i + 1 < argc) {
+            if (!parse_trace_trigger_pc(argv[++i], &opts->trace)) {
+                fprintf(stderr, "Error: Bad --trace-trigger-pc %s\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--trace-trigger-addr") == 0 && i + 1 < argc) {
+            if (!parse_trace_trigger_addr(argv[++i], &opts->trace)) {
+                fprintf(stderr, "Error: Bad --trace-trigger-addr %s\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--trace-pre") == 0 && i + 1 < argc) {
+            uint64_t cycles;
+            if (!parse_number(argv[i], argv[i + 1], 0, UINT32_MAX, &cycles)) return false;
+            i++;
+            opts->trace.pre_cycles = cycles >= MAX_TRACE_LINES ? MAX_TRACE_LINES - 1 : (uint32_t)cycles;
+        } else if (strcmp(argv[i], "--trace-post") == 0 && i + 1 < argc) {
+            uint64_t cycles;
+            if (!parse_number(argv[i], argv[i + 1], 0, UINT32_MAX, &cycles)) return false;
+            i++;
+            opts->trace.post_cycles = (uint32_t)cycles;
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] [imem0.txt imem1.txt imem2.txt imem3.txt memin.txt]\n", prog);
+    fprintf(stderr, "   OR: %s [options] [all 27 files]\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --miss-classify    Classify misses (3C + coherence), writes missclass.csv\n");
+    fprintf(stderr, "  --hotspots         Charge stalls and misses to PCs, writes hotspots.txt (annotated listing)\n");
+    fprintf(stderr, "  --sharing-report   Rank blocks by coherence cost, flag false sharing and ping-pong (sharing.txt)\n");
+    fprintf(stderr, "  --timeline FILE    Stream stage, stall, miss and bus spans as Chrome trace-event JSON\n");
+    fprintf(stderr, "  --interval N       Counter deltas every N cycles (IPC, misses, stalls, bus), writes intervals.csv\n");
+    fprintf(stderr, "  --record-mem FILE  Write every core's LW/SW references with their timing\n");
+    fprintf(stderr, "  --replay-mem FILE  Drive caches and bus from a recorded trace, no pipelines (fast)\n");
+    fprintf(stderr, "  --dram             Banked DRAM timing (row buffers, refresh, FR-FCFS), writes dram.txt\n");
+    fprintf(stderr, "  --llc WORDS        Shared last-level cache behind the bus, writes llcstats/llcdsram/llctsram.txt\n");
+    fprintf(stderr, "  --llc-ways N       LLC associativity (default %d)\n", LLC_DEFAULT_WAYS);
+    fprintf(stderr, "  --llc-latency N    Cycles to the first word on an LLC hit (default %d)\n", LLC_DEFAULT_LATENCY);
+    fprintf(stderr, "  --llc-policy P     inclusive (default), non-inclusive or exclusive\n");
+    fprintf(stderr, "  --self-profile     Print host time per simulator phase and cycles/s after the run\n");
+    fprintf(stderr, "  --starvation-threshold N\n");
+    fprintf(stderr, "                     Bus wait (cycles) reported as starvation in busqueue.txt\n");
+    fprintf(stderr, "  --output-threads N Threads writing the output files (default %d)\n", OUTPUT_DEFAULT_THREADS);
+    fprintf(stderr, "  --spin-ff          Fast-forward cores spinning on a cached flag (outputs unchanged)\n");
+    fprintf(stderr, "  --warm-start DIR   Start from DIR/memout.txt, dsramN.txt, tsramN.txt of a saved run\n");
+    fprintf(stderr, "  --functional       ISA-level run without timing: memout/regout only, empty traces\n");
+    fprintf(stderr, "  --cosim            Check every retired instruction against an ISA reference model\n");
+    fprintf(stderr, "  --server           Run jobs sent on stdin, results on stdout (protocol: src/server.c)\n");
+    fprintf(stderr, "  --server-socket PATH\n");
+    fprintf(stderr, "                     Same, listening on a Unix socket\n");
+    fprintf(stderr, "Trace control (default: full traces):\n");
+    fprintf(stderr, "  --no-trace         Performance mode: no trace work, trace files are empty\n");
+    fprintf(stderr, "  --trace LIST       Traced streams: core0..core3, bus, all, none (comma-separated)\n");
+    fprintf(stderr, "  --trace-window A:B Only trace cycles A..B (repeatable, up to %d)\n", MAX_TRACE_WINDOWS);
+    fprintf(stderr, "  --trace-trigger-pc [CORE:]PC\n");
+    fprintf(stderr, "                     Record only around fetches of PC (hex)\n");
+    fprintf(stderr, "  --trace-trigger-addr ADDR\n");
+    fprintf(stderr, "                     Record only around loads/stores to ADDR (hex word address)\n");
+    fprintf(stderr, "  --trace-pre N      Cycles kept before a trigger (default %d)\n", TRACE_DEFAULT_PRE);
+    fprintf(stderr, "  --trace-post N     Cycles recorded after a trigger (default %d)\n", TRACE_DEFAULT_POST);
+    fprintf(stderr, "  --fingerprint FILE Hash trace records into FILE instead of writing trace text\n");
+    fprintf(stderr, "  --fingerprint-interval N\n");
+    fprintf(stderr, "                     Cycles per fingerprint checkpoint window (default %d)\n", FINGERPRINT_DEFAULT_INTERVAL);
+}
 
 int main(int argc, char *argv[]) {
     Simulator *sim = NULL;  // Allocate on heap to avoid stack overflow
     const char *files[NUM_FILES];
+    SimOptions options;
+    char **args = (char **)malloc(sizeof(char *) * (argc + 1));
+    int status = 1;
+
+    if (!args || !parse_options(argc, argv, &options, args, &argc)) {
+        print_usage(argv[0]);
+        goto cleanup;
+    }
+    argv = args;
+
+    // Server mode: jobs arrive over the protocol instead of as file arguments
+    if (options.server) {
+        status = run_server(&options, options.server_socket);
+        goto cleanup;
+    }
+
+#if SIM_PROFILE
+    if (options.self_profile) {
+        profile_enabled = true;
+        profile_start();
+    }
+#else
+    if (options.self_profile) {
+        fprintf(stderr, "Warning: built with SIM_PROFILE=0, --self-profile ignored\n");
+    }
+#endif
 
     // Print current working directory for debugging
     char cwd[1024];
-    if (_getcwd(cwd, sizeof(cwd)) != NULL) {
+    if (getcwd(cwd, sizeof(cwd)) != NULL) {
         printf("Current working directory: %s\n", cwd);
     }
 
@@ -61,30 +321,25 @@ int main(int argc, char *argv[]) {
             files[i] = argv[i + 1];
         }
     } else {
-        fprintf(stderr, "Usage: %s [imem0.txt imem1.txt imem2.txt imem3.txt memin.txt]\n", argv[0]);
-        fprintf(stderr, "   OR: %s [all 27 files]\n", argv[0]);
-        return 1;
+        print_usage(argv[0]);
+        goto cleanup;
     }
 
-    // Allocate simulator on heap (avoid stack overflow - 8MB+ structure)
+    // Allocate and initialize the simulator; traces and main memory live in its arena
     printf("Allocating simulator memory...\n");
-    sim = (Simulator *)calloc(1, sizeof(Simulator));
+    sim = simlib_create(&options);
     if (!sim) {
-        fprintf(stderr, "Error: Failed to allocate memory for simulator\n");
-        return 1;
+        fprintf(stderr, "Error: Could not create the simulator (see above)\n");
+        goto cleanup;
     }
-
-    // Initialize simulator
-    printf("Initializing simulator...\n");
-    init_simulator(sim);
+    if (options.self_profile) printf("Arena: %zu MB, %s\n", sim->arena.size >> 20, arena_kind_name(sim->arena.kind));
 
     // Load instruction memories
     printf("Loading instruction memories...\n");
     for (int i = 0; i < NUM_CORES; i++) {
         if (!load_imem(files[i], sim->cores[i].imem)) {
             fprintf(stderr, "Error loading %s\n", files[i]);
-            free(sim);
-            return 1;
+            goto cleanup;
         }
     }
 
@@ -102,87 +357,69 @@ int main(int argc, char *argv[]) {
     printf("Loading main memory...\n");
     if (!load_memin(files[4], &sim->main_memory)) {
         fprintf(stderr, "Error loading %s\n", files[4]);
-        free(sim);
-        return 1;
+        goto cleanup;
+    }
+    if (options.warm_start) {
+        printf("Warm start from %s...\n", options.warm_start);
+        if (!simlib_warm_start(sim, options.warm_start)) {
+            fprintf(stderr, "Error: Warm start from %s failed\n", options.warm_start);
+            goto cleanup;
+        }
     }
     
 
     // Run simulation
     printf("Starting simulation...\n");
-    run_simulator(sim);
-    printf("Simulation completed after %llu cycles\n", sim->global_cycle);
-
-    // Save outputs
-    printf("Saving outputs...\n");
-
-    // Memory output
-    if (!save_memout(files[5], &sim->main_memory)) {
-        fprintf(stderr, "Error saving %s\n", files[5]);
-        free(sim);
-        return 1;
-    }
-
-    // Register outputs
-    for (int i = 0; i < NUM_CORES; i++) {
-        if (!save_regout(files[6 + i], &sim->cores[i])) {
-            fprintf(stderr, "Error saving %s\n", files[6 + i]);
-            free(sim);
-            return 1;
+    if (options.functional) {
+        if (simlib_run_functional(sim, FUNC_DEFAULT_LIMIT) != SIM_STOP_DONE) {
+            printf("Warning: Functional run stopped before every core halted\n");
         }
-    }
-
-    // Core traces
-    for (int i = 0; i < NUM_CORES; i++) {
-        if (!save_trace(files[10 + i], &sim->cores[i])) {
-            fprintf(stderr, "Error saving %s\n", files[10 + i]);
-            free(sim);
-            return 1;
+        printf("Functional run: %llu block(s) translated\n", (unsigned long long)sim->func.blocks_translated);
+    } else if (options.replay_mem) {
+        if (!simlib_run_memory_trace(sim, options.replay_mem)) {
+            fprintf(stderr, "Error: Replay of %s failed\n", options.replay_mem);
+            goto cleanup;
         }
+    } else {
+        simlib_run(sim);
     }
-
-    // Bus trace
-    if (!save_bustrace(files[14], &sim->bus)) {
-        fprintf(stderr, "Error saving %s\n", files[14]);
-        free(sim);
-        return 1;
+    printf("Simulation completed after %llu cycles\n", (unsigned long long)sim->global_cycle);
+    if (sim->options.trace.trigger_pc_enabled || sim->options.trace.trigger_addr_enabled) {
+        printf("Trace trigger fired %llu time(s)\n", (unsigned long long)sim->trace.triggers);
     }
 
-    // DSRAM outputs
-    for (int i = 0; i < NUM_CORES; i++) {
-        if (!save_dsram(files[15 + i], &sim->cores[i].cache)) {
-            fprintf(stderr, "Error saving %s\n", files[15 + i]);
-            free(sim);
-            return 1;
-        }
+    // Save outputs
+    printf("Saving outputs...\n");
+    if (!simlib_save_outputs(sim, files)) {
+        goto cleanup;
     }
 
-    // TSRAM outputs
-    for (int i = 0; i < NUM_CORES; i++) {
-        if (!save_tsram(files[19 + i], &sim->cores[i].cache)) {
-            fprintf(stderr, "Error saving %s\n", files[19 + i]);
-            free(sim);
-            return 1;
-        }
+    printf("All outputs saved successfully\n");
+    status = 0;
+    if (sim->cosim.failed) {
+        fprintf(stderr, "Error: Co-simulation mismatch (see above); outputs show the state when the run stopped\n");
+        status = 1;
     }
-
-    // Statistics outputs
-    for (int i = 0; i < NUM_CORES; i++) {
-        if (!save_stats(files[23 + i], &sim->cores[i])) {
-            fprintf(stderr, "Error saving %s\n", files[23 + i]);
-            free(sim);
-            return 1;
-        }
+    if (sim->spin.enabled) {
+        printf("Spin fast-forward: %llu loop(s) parked, %llu core-cycles replayed\n",
+               (unsigned long long)sim->spin.parks, (unsigned long long)sim->spin.replayed);
+    }
+    if (sim->cosim.enabled && !sim->cosim.failed) {
+        printf("Co-simulation: %llu instructions checked, no mismatch\n", (unsigned long long)sim->cosim.checked);
     }
-
-    printf("All outputs saved successfully\n");
     printf("\nSimulation Summary:\n");
     for (int i = 0; i < NUM_CORES; i++) {
         printf("Core %d: %llu cycles, %llu instructions\n",
-               i, sim->cores[i].cycles, sim->cores[i].instructions);
+               i, (unsigned long long)sim->cores[i].cycles, (unsigned long long)sim->cores[i].instructions);
     }
 
-    // Free allocated memory
-    free(sim);
+#if SIM_PROFILE
+    if (profile_enabled) profile_report(stdout);
+#endif
 
-    return 0;
+cleanup:
+    // Free allocated memory
+    simlib_destroy(sim);
+    free(args);
+    return status;
 }
@@ -0,0 +1,246 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// MEMORY-REFERENCE TRACE (--record-mem FILE / --replay-mem FILE)
+// Recording: stage_memory writes one line per LW/SW at its first attempt,
+//   "<core> <gap> <L|S> <addr> <data>"
+// where gap is the number of cycles since the core's previous reference
+// performed (hit), or since cycle 0. "<core> <gap> H" lines close the run:
+// the core's cycle count follows from the gap.
+//
+// Replay skips the pipeline: each core attempts its next reference gap cycles
+// after the previous one performed, through cache_read / cache_write, and
+// retries every cycle until it hits, as stage_memory does; bus_cycle runs
+// unchanged. The cycle after a load performs, stage_writeback reads its word
+// again; if a snoop invalidated the block in between, that re-read misses and
+// puts a BusRd on the bus, so replay repeats it (it is not in the trace).
+// Cycles with the bus idle and no reference or re-read due are skipped.
+// While a MEM stall freezes the whole pipeline, the cycles between one access
+// performing and the next being attempted depend only on the program, so the
+// replay of an unchanged configuration reproduces the bus trace, caches,
+// memory and the hit/miss/mem_stall statistics exactly. After a cache, protocol
+// or bus change the replay keeps the recorded instruction stream: loads whose
+// values would steer control flow differently are not modelled.
+// ====================================================================================
+
+#define MEMTRACE_HEADER "# memtrace: core gap L|S|H addr data (gap: cycles since the previous reference performed)"
+
+bool memtrace_record_open(Simulator *sim, const char *filename) {
+    MemTrace *mt = &sim->memtrace;
+    mt->record = fopen(filename, "w");
+    if (!mt->record) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+    setvbuf(mt->record, NULL, _IOFBF, 1 << 20);
+    fprintf(mt->record, "%s\n", MEMTRACE_HEADER);
+    memset(mt->performed, 0, sizeof(mt->performed));
+    return true;
+}
+
+// Called from stage_memory for every LW/SW attempt
+void memtrace_record(Simulator *sim, int core_id, bool is_write, uint32_t addr, uint32_t data,
+                     bool hit, bool first_attempt) {
+    MemTrace *mt = &sim->memtrace;
+    if (first_attempt) {
+        fprintf(mt->record, "%d %llu %c %06X %08X\n", core_id,
+                (unsigned long long)(sim->global_cycle - mt->performed[core_id]),
+                is_write ? MEMREF_STORE : MEMREF_LOAD, addr & (MAIN_MEM_SIZE - 1), is_write ? data : 0);
+    }
+    if (hit) mt->performed[core_id] = sim->global_cycle;
+}
+
+// Finish a recording with each core's end, and drop a loaded trace
+void memtrace_close(Simulator *sim) {
+    MemTrace *mt = &sim->memtrace;
+    if (mt->record) {
+        for (int i = 0; i < NUM_CORES; i++) {
+            fprintf(mt->record, "%d %llu %c\n", i,
+                    (unsigned long long)(sim->cores[i].cycles - mt->performed[i]), MEMREF_HALT);
+        }
+        fclose(mt->record);
+    }
+    if (mt->cores) {
+        for (int i = 0; i < NUM_CORES; i++) free(mt->cores[i].refs);
+        free(mt->cores);
+    }
+    memset(mt, 0, sizeof(MemTrace));
+}
+
+// ====================================================================================
+// REPLAY
+// ====================================================================================
+
+static bool append_ref(MemTraceCore *mc, const MemRef *ref) {
+    if (mc->count == mc->capacity) {
+        int grow = mc->capacity ? mc->capacity * 2 : 1024;
+        MemRef *p = (MemRef *)realloc(mc->refs, (size_t)grow * sizeof(MemRef));
+        if (!p) return false;
+        mc->refs = p;
+        mc->capacity = grow;
+    }
+    mc->refs[mc->count++] = *ref;
+    return true;
+}
+
+static bool load_memtrace(Simulator *sim, const char *filename) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for reading\n", filename);
+        return false;
+    }
+    MemTrace *mt = &sim->memtrace;
+    mt->cores = (MemTraceCore *)calloc(NUM_CORES, sizeof(MemTraceCore));
+    if (!mt->cores) {
+        fprintf(stderr, "Error: Out of memory for the memory trace\n");
+        fclose(fp);
+        return false;
+    }
+
+    char line[128];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+
+        int core_id;
+        unsigned long long gap;
+        char op;
+        unsigned int addr = 0, data = 0;
+        int fields = sscanf(line, "%d %llu %c %x %x", &core_id, &gap, &op, &addr, &data);
+        bool valid = fields >= 3 && core_id >= 0 && core_id < NUM_CORES &&
+                     (op == MEMREF_HALT || (fields == 5 && (op == MEMREF_LOAD || op == MEMREF_STORE)));
+        if (!valid) {
+            fprintf(stderr, "Error: %s line %d: expected \"core gap L|S addr data\" or \"core gap H\"\n",
+                    filename, line_no);
+            ok = false;
+            break;
+        }
+        MemRef ref = { gap, addr & (MAIN_MEM_SIZE - 1), data, (MemRefOp)op };
+        if (!append_ref(&mt->cores[core_id], &ref)) {
+            fprintf(stderr, "Error: Out of memory for the memory trace\n");
+            ok = false;
+        }
+    }
+    fclose(fp);
+    return ok;
+}
+
+// The core ran cycles [0, end)
+static void finish_core(Simulator *sim, int core_id, uint64_t end) {
+    sim->memtrace.cores[core_id].done = true;
+    sim->cores[core_id].cycles = end;
+    sim->cores[core_id].halted = true;
+}
+
+// Next reference due: its first attempt is gap cycles after the last one performed
+static void advance(Simulator *sim, int core_id) {
+    MemTraceCore *mc = &sim->memtrace.cores[core_id];
+    mc->issued = false;
+    if (mc->next == mc->count) {
+        finish_core(sim, core_id, sim->memtrace.performed[core_id] + 1);     // Trace without an end line
+        return;
+    }
+    mc->ready = sim->memtrace.performed[core_id] + mc->refs[mc->next].gap;
+}
+
+// One cycle of stage_writeback's load re-read and stage_memory for the core's
+// current reference, in that order
+static void replay_access(Simulator *sim, int core_id) {
+    MemTraceCore *mc = &sim->memtrace.cores[core_id];
+    Core *core = &sim->cores[core_id];
+    if (mc->reread) {
+        uint32_t word;
+        MESIState state = tag_lane_state(tag_dir_probe(&sim->tags, mc->reread_addr), core_id);
+        cache_read(&core->cache, mc->reread_addr, state, &word, sim, core_id);
+        mc->reread = false;
+    }
+    if (mc->done || (!mc->issued && sim->global_cycle < mc->ready)) return;
+
+    const MemRef *ref = &mc->refs[mc->next];
+    bool is_write = ref->op == MEMREF_STORE;
+    uint32_t loaded;
+    MESIState state = tag_lane_state(tag_dir_probe(&sim->tags, ref->addr), core_id);
+    bool hit = is_write ? cache_write(&core->cache, ref->addr, state, ref->data, sim, core_id)
+                        : cache_read(&core->cache, ref->addr, state, &loaded, sim, core_id);
+
+    if (!mc->issued) {
+        if (is_write) {
+            if (hit) core->write_hit++;
+            else core->write_miss++;
+        } else {
+            if (hit) core->read_hit++;
+            else core->read_miss++;
+        }
+    }
+    if (hit) {
+        if (sim->sharing.enabled) sharing_access(sim, core_id, ref->addr, is_write);
+        sim->memtrace.performed[core_id] = sim->global_cycle;
+        mc->reread = !is_write;
+        mc->reread_addr = ref->addr;
+        mc->next++;
+        advance(sim, core_id);
+    } else {
+        mc->issued = true;
+        core->mem_stall++;
+        PERF_INC(core->perf, mem_stall_cause(sim, core_id));
+    }
+}
+
+// Run the memory system from a --record-mem trace instead of the pipelines.
+// Main memory (and warm-start caches) must be loaded; false on a bad trace.
+bool memtrace_replay(Simulator *sim, const char *filename) {
+    MemTrace *mt = &sim->memtrace;
+    if (!load_memtrace(sim, filename)) return false;
+    for (int i = 0; i < NUM_CORES; i++) {
+        mt->performed[i] = sim->global_cycle;
+        advance(sim, i);
+    }
+
+    BusArbiter *bus = &sim->bus;
+    for (;;) {
+        // An end line is due at the core's last cycle + 1, which is never simulated
+        bool active = false;
+        uint64_t next_due = UINT64_MAX;
+        for (int i = 0; i < NUM_CORES; i++) {
+            MemTraceCore *mc = &mt->cores[i];
+            if (!mc->done && !mc->issued && mc->refs[mc->next].op == MEMREF_HALT && sim->global_cycle >= mc->ready) {
+                finish_core(sim, i, mc->ready);
+            }
+            if (mc->reread) {
+                active = true;
+                next_due = sim->global_cycle;
+            }
+            if (mc->done) continue;
+            active = true;
+            if (mc->issued) next_due = sim->global_cycle;
+            else if (mc->ready < next_due) next_due = mc->ready;
+        }
+        bool bus_idle = bus->state == BUS_STATE_IDLE;
+        for (int i = 0; i < NUM_CORES; i++) bus_idle = bus_idle && !bus->pending[i];
+        if (!active && bus_idle) break;
+
+        // Nothing can happen until the next reference is due
+        if (bus_idle && next_due > sim->global_cycle && next_due != UINT64_MAX) {
+#if PERF_COUNTERS
+            bus->perf[PERF_BUS_IDLE_CYCLES] += next_due - sim->global_cycle;
+#endif
+            sim->global_cycle = next_due;
+            continue;
+        }
+
+        trace_cycle_begin(sim);
+        if (sim->fingerprint.enabled) fingerprint_cycle(&sim->fingerprint, sim->global_cycle);
+        bus_cycle(sim);
+        for (int i = 0; i < NUM_CORES; i++) replay_access(sim, i);
+        sim->global_cycle++;
+    }
+    return true;
+}
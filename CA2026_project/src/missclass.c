@@ -0,0 +1,165 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// MISS CLASSIFICATION (3C + COHERENCE)
+// A miss is classified in priority order:
+//   1. SW to a Shared block               -> upgrade
+//   2. block was invalidated by a snoop   -> coherence; true sharing if a remote
+//                                            core wrote the accessed word before the fill
+//   3. block never referenced before      -> compulsory
+//   4. misses in the FA LRU shadow cache  -> capacity
+//   5. otherwise                          -> conflict
+// ====================================================================================
+
+static const char *MISS_CLASS_NAMES[MISS_CLASS_NUM] = {
+    "compulsory", "capacity", "conflict", "coherence_true", "coherence_false", "upgrade"
+};
+
+const char* miss_class_name(int cls) {
+    if (cls < 0 || cls >= MISS_CLASS_NUM) return "unknown";
+    return MISS_CLASS_NAMES[cls];
+}
+
+static inline uint32_t block_number(uint32_t addr) {
+    return (addr & (MAIN_MEM_SIZE - 1)) >> 3;
+}
+
+static bool shadow_contains(MissClassifier *mc, uint32_t block) {
+    for (int i = 0; i < mc->shadow_count; i++) {
+        if (mc->shadow[i] == block) return true;
+    }
+    return false;
+}
+
+// Move block to the MRU position, dropping the LRU block when full
+static void shadow_touch(MissClassifier *mc, uint32_t block) {
+    int pos = mc->shadow_count;
+    for (int i = 0; i < mc->shadow_count; i++) {
+        if (mc->shadow[i] == block) {
+            pos = i;
+            break;
+        }
+    }
+    if (pos == mc->shadow_count) {
+        if (mc->shadow_count < NUM_CACHE_BLOCKS) mc->shadow_count++;
+        else pos = NUM_CACHE_BLOCKS - 1;
+    }
+    memmove(&mc->shadow[1], &mc->shadow[0], pos * sizeof(uint32_t));
+    mc->shadow[0] = block;
+}
+
+static MissClass classify_miss(Simulator *sim, int core_id, uint32_t addr, bool is_write) {
+    MissClassifier *mc = &sim->miss_class[core_id];
+    uint32_t block = addr & ~0x7;
+    uint8_t index = (addr >> 3) & 0x3F;
+    if (is_write && tag_lane_state(tag_dir_probe(&sim->tags, addr), core_id) == MESI_SHARED) {
+        return MISS_UPGRADE;
+    }
+
+    // Reported as coherence here; true vs false sharing is decided when the fill
+    // completes, since the remote store usually performs while we wait for the bus
+    MissInvalRecord *rec = &mc->inval[index];
+    if (rec->valid && rec->block == block) {
+        return MISS_COHERENCE_TRUE;
+    }
+
+    uint32_t bn = block_number(addr);
+    if (!(mc->seen[bn >> 3] & (1 << (bn & 7)))) return MISS_COMPULSORY;
+    if (!shadow_contains(mc, block)) return MISS_CAPACITY;
+    return MISS_CONFLICT;
+}
+
+// Called from stage_memory for every LW/SW attempt
+void miss_classify_access(Simulator *sim, int core_id, uint16_t pc, uint32_t addr,
+                          bool is_write, bool hit, bool first_attempt) {
+    MissClassifier *mc = &sim->miss_class[core_id];
+    uint32_t block = addr & ~0x7;
+    uint8_t index = (addr >> 3) & 0x3F;
+
+    // A performed store marks the word as remotely written for every core
+    // that lost this block to an invalidation
+    if (is_write && hit) {
+        for (int i = 0; i < NUM_CORES; i++) {
+            MissInvalRecord *rec = &sim->miss_class[i].inval[index];
+            if (i != core_id && rec->valid && rec->block == block) {
+                rec->remote_written |= (uint8_t)(1 << (addr & 0x7));
+            }
+        }
+    }
+
+    // Outstanding coherence miss completes: true sharing if a remote core wrote our word
+    if (hit && mc->coherence_pending) {
+        MissInvalRecord *rec = &mc->inval[index];
+        MissClass cls = (rec->remote_written & (1 << (addr & 0x7))) ? MISS_COHERENCE_TRUE : MISS_COHERENCE_FALSE;
+        mc->total[cls]++;
+        mc->per_pc[mc->coherence_pc % IMEM_SIZE][cls]++;
+        mc->coherence_pending = false;
+        rec->valid = false;
+    }
+
+    // Statistics count the first attempt only (retries are the same miss)
+    if (!first_attempt) return;
+
+    if (!hit) {
+        MissClass cls = classify_miss(sim, core_id, addr, is_write);
+        if (cls == MISS_COHERENCE_TRUE) {
+            mc->coherence_pending = true;
+            mc->coherence_pc = pc;
+        } else {
+            if (cls != MISS_UPGRADE) mc->inval[index].valid = false;  // Set is refilled
+            mc->total[cls]++;
+            mc->per_pc[pc % IMEM_SIZE][cls]++;
+        }
+    }
+
+    uint32_t bn = block_number(addr);
+    mc->seen[bn >> 3] |= (uint8_t)(1 << (bn & 7));
+    shadow_touch(mc, block);
+}
+
+// Called from cache_snoop when a BusRdX removes a valid block from core_id's cache
+void miss_classify_invalidation(Simulator *sim, int core_id, uint32_t addr) {
+    MissInvalRecord *rec = &sim->miss_class[core_id].inval[(addr >> 3) & 0x3F];
+    rec->valid = true;
+    rec->block = addr & ~0x7;
+    rec->remote_written = 0;
+}
+
+// CSV: one "all" row per core with totals, then one row per PC that missed
+bool save_miss_classification(const char *filename, Simulator *sim) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "core,pc");
+    for (int c = 0; c < MISS_CLASS_NUM; c++) fprintf(fp, ",%s", MISS_CLASS_NAMES[c]);
+    fprintf(fp, "\n");
+
+    for (int i = 0; i < NUM_CORES; i++) {
+        MissClassifier *mc = &sim->miss_class[i];
+
+        fprintf(fp, "%d,all", i);
+        for (int c = 0; c < MISS_CLASS_NUM; c++) fprintf(fp, ",%llu", (unsigned long long)mc->total[c]);
+        fprintf(fp, "\n");
+
+        for (int pc = 0; pc < IMEM_SIZE; pc++) {
+            uint32_t sum = 0;
+            for (int c = 0; c < MISS_CLASS_NUM; c++) sum += mc->per_pc[pc][c];
+            if (sum == 0) continue;
+
+            fprintf(fp, "%d,%03X", i, pc);
+            for (int c = 0; c < MISS_CLASS_NUM; c++) fprintf(fp, ",%u", mc->per_pc[pc][c]);
+            fprintf(fp, "\n");
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
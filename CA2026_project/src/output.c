@@ -0,0 +1,262 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#endif
+
+// ====================================================================================
+// FAST FORMATTERS
+// Shared by every save_* writer and by the trace line formatters.
+// ====================================================================================
+
+// Two hex digits per byte value, so one lookup emits a whole byte
+static const char HEX_PAIRS[513] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+// Equivalent to sprintf("%0<digits>X") for values that fit; returns the end of the digits
+char* fmt_hex(char *dst, uint32_t value, int digits) {
+    char *p = dst + digits;
+    while (p - dst >= 2) {
+        p -= 2;
+        memcpy(p, &HEX_PAIRS[(value & 0xFF) * 2], 2);
+        value >>= 8;
+    }
+    if (p > dst) *--p = HEX_PAIRS[(value & 0xF) * 2 + 1];
+    return dst + digits;
+}
+
+// Equivalent to sprintf("%llu"); returns the end of the digits
+char* fmt_u64(char *dst, uint64_t value) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n) *dst++ = tmp[--n];
+    return dst;
+}
+
+// ====================================================================================
+// BUFFERED WRITER
+// One large aligned buffer per open file; stdio buffering is turned off so
+// every flush is a single fwrite straight from it.
+// ====================================================================================
+
+static void *aligned_buffer(size_t size) {
+#ifdef _WIN32
+    return _aligned_malloc(size, OUTBUF_ALIGN);
+#else
+    void *p = NULL;
+    return posix_memalign(&p, OUTBUF_ALIGN, size) == 0 ? p : NULL;
+#endif
+}
+
+static void aligned_free(void *p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+bool outbuf_open(OutBuf *ob, FILE *fp) {
+    ob->fp = fp;
+    ob->len = 0;
+    ob->ok = true;
+    ob->buf = (char *)aligned_buffer(OUTBUF_SIZE);
+    if (!ob->buf) {
+        fclose(fp);
+        return false;
+    }
+    setvbuf(fp, NULL, _IONBF, 0);
+    return true;
+}
+
+void outbuf_flush(OutBuf *ob) {
+    if (ob->len && fwrite(ob->buf, 1, ob->len, ob->fp) != ob->len) ob->ok = false;
+    ob->len = 0;
+}
+
+void outbuf_write(OutBuf *ob, const char *s, size_t n) {
+    if (ob->len + n > OUTBUF_SIZE) {
+        outbuf_flush(ob);
+        if (n > OUTBUF_SIZE) {
+            if (fwrite(s, 1, n, ob->fp) != n) ob->ok = false;
+            return;
+        }
+    }
+    memcpy(ob->buf + ob->len, s, n);
+    ob->len += n;
+}
+
+// "%08X\n"
+void outbuf_hex_line(OutBuf *ob, uint32_t value) {
+    if (ob->len + 9 > OUTBUF_SIZE) outbuf_flush(ob);
+    char *p = fmt_hex(ob->buf + ob->len, value, 8);
+    *p = '\n';
+    ob->len += 9;
+}
+
+// "<name> %llu\n"
+void outbuf_stat_line(OutBuf *ob, const char *name, uint64_t value) {
+    char line[64];
+    size_t n = strlen(name);
+    if (n > 40) n = 40;
+    memcpy(line, name, n);
+    line[n++] = ' ';
+    char *end = fmt_u64(line + n, value);
+    *end++ = '\n';
+    outbuf_write(ob, line, (size_t)(end - line));
+}
+
+bool outbuf_close(OutBuf *ob) {
+    outbuf_flush(ob);
+    if (fclose(ob->fp) != 0) ob->ok = false;
+    aligned_free(ob->buf);
+    ob->buf = NULL;
+    return ob->ok;
+}
+
+// ====================================================================================
+// PARALLEL OUTPUT
+// The 22 output files are independent, so they are written by a small pool
+// of worker threads pulling jobs from a shared index.
+// ====================================================================================
+
+typedef enum {
+    OUT_MEMOUT, OUT_REGOUT, OUT_TRACE, OUT_BUSTRACE, OUT_DSRAM, OUT_TSRAM, OUT_STATS
+} OutputKind;
+
+typedef struct {
+    OutputKind kind;
+    int core;
+    int file_index;     // Position in files[]
+    bool ok;
+} OutputJob;
+
+typedef struct {
+    Simulator *sim;
+    const char **files;
+    OutputJob *jobs;
+    int count;
+    volatile long next;
+} OutputQueue;
+
+static long output_next_job(volatile long *next) {
+#ifdef _WIN32
+    return InterlockedIncrement(next) - 1;
+#else
+    return __sync_fetch_and_add(next, 1);
+#endif
+}
+
+static void run_output_job(Simulator *sim, const char *filename, OutputJob *job) {
+    Core *core = &sim->cores[job->core];
+    switch (job->kind) {
+    case OUT_MEMOUT:   job->ok = save_memout(filename, &sim->main_memory); break;
+    case OUT_REGOUT:   job->ok = save_regout(filename, core); break;
+    case OUT_TRACE: {
+        PROFILE_BEGIN(PROF_SAVE_TRACES);
+        job->ok = save_trace(filename, core);
+        PROFILE_END(PROF_SAVE_TRACES);
+        break;
+    }
+    case OUT_BUSTRACE: {
+        PROFILE_BEGIN(PROF_SAVE_TRACES);
+        job->ok = save_bustrace(filename, &sim->bus);
+        PROFILE_END(PROF_SAVE_TRACES);
+        break;
+    }
+    case OUT_DSRAM:    job->ok = save_dsram(filename, &core->cache); break;
+    case OUT_TSRAM:    job->ok = save_tsram(filename, &sim->tags, job->core); break;
+    case OUT_STATS:    job->ok = save_stats(filename, core); break;
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI output_worker(LPVOID arg)
+#else
+static void *output_worker(void *arg)
+#endif
+{
+    OutputQueue *q = (OutputQueue *)arg;
+    for (;;) {
+        long i = output_next_job(&q->next);
+        if (i >= q->count) break;
+        run_output_job(q->sim, q->files[q->jobs[i].file_index], &q->jobs[i]);
+    }
+    return 0;
+}
+
+// files[] uses the command-line layout (outputs at 5..26). Errors are reported
+// in file order once every job has finished.
+bool save_outputs(const char *files[], Simulator *sim, int threads) {
+    OutputJob jobs[22];
+    int n = 0;
+
+    // Largest files first so the long jobs start immediately
+    for (int i = 0; i < NUM_CORES; i++) jobs[n++] = (OutputJob){ OUT_TRACE, i, 10 + i, false };
+    jobs[n++] = (OutputJob){ OUT_MEMOUT, 0, 5, false };
+    jobs[n++] = (OutputJob){ OUT_BUSTRACE, 0, 14, false };
+    for (int i = 0; i < NUM_CORES; i++) jobs[n++] = (OutputJob){ OUT_DSRAM, i, 15 + i, false };
+    for (int i = 0; i < NUM_CORES; i++) jobs[n++] = (OutputJob){ OUT_TSRAM, i, 19 + i, false };
+    for (int i = 0; i < NUM_CORES; i++) jobs[n++] = (OutputJob){ OUT_REGOUT, i, 6 + i, false };
+    for (int i = 0; i < NUM_CORES; i++) jobs[n++] = (OutputJob){ OUT_STATS, i, 23 + i, false };
+
+    OutputQueue queue = { sim, files, jobs, n, 0 };
+    if (threads < 1) threads = 1;
+    if (threads > OUTPUT_MAX_THREADS) threads = OUTPUT_MAX_THREADS;
+
+#ifdef _WIN32
+    HANDLE workers[OUTPUT_MAX_THREADS];
+#else
+    pthread_t workers[OUTPUT_MAX_THREADS];
+#endif
+    int started = 0;
+    for (int t = 1; t < threads; t++) {
+#ifdef _WIN32
+        workers[started] = CreateThread(NULL, 0, output_worker, &queue, 0, NULL);
+        if (workers[started]) started++;
+#else
+        if (pthread_create(&workers[started], NULL, output_worker, &queue) == 0) started++;
+#endif
+    }
+    output_worker(&queue);  // The calling thread works too
+    for (int t = 0; t < started; t++) {
+#ifdef _WIN32
+        WaitForSingleObject(workers[t], INFINITE);
+        CloseHandle(workers[t]);
+#else
+        pthread_join(workers[t], NULL);
+#endif
+    }
+
+    // Report failures in the original output order
+    bool ok = true;
+    for (int f = 5; f < 27; f++) {
+        for (int j = 0; j < n; j++) {
+            if (jobs[j].file_index == f && !jobs[j].ok) {
+                fprintf(stderr, "Error saving %s\n", files[f]);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
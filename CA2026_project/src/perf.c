@@ -0,0 +1,184 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// COUNTER REGISTRY
+// ====================================================================================
+
+#define PERF_COUNTER_NAME(id, name) name,
+
+static const char *CORE_PERF_NAMES[CORE_PERF_NUM] = {
+    CORE_PERF_COUNTER_LIST(PERF_COUNTER_NAME)
+};
+
+static const char *BUS_PERF_NAMES[BUS_PERF_NUM] = {
+    BUS_PERF_COUNTER_LIST(PERF_COUNTER_NAME)
+};
+
+const char* core_perf_counter_name(int id) {
+    if (id < 0 || id >= CORE_PERF_NUM) return "unknown";
+    return CORE_PERF_NAMES[id];
+}
+
+const char* bus_perf_counter_name(int id) {
+    if (id < 0 || id >= BUS_PERF_NUM) return "unknown";
+    return BUS_PERF_NAMES[id];
+}
+
+// ====================================================================================
+// OUTPUT
+// ====================================================================================
+
+#if PERF_COUNTERS
+
+// Same "name value" format as stats*.txt so existing tooling can parse it
+bool save_perf_stats(const char *filename, Core *core) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    for (int i = 0; i < CORE_PERF_NUM; i++) {
+        fprintf(fp, "%s %llu\n", CORE_PERF_NAMES[i], (unsigned long long)core->perf[i]);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+bool save_bus_perf_stats(const char *filename, BusArbiter *bus) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    for (int i = 0; i < BUS_PERF_NUM; i++) {
+        fprintf(fp, "%s %llu\n", BUS_PERF_NAMES[i], (unsigned long long)bus->perf[i]);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+bool save_perf_json(const char *filename, Simulator *sim) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "{\n  \"global_cycles\": %llu,\n  \"cores\": [\n",
+            (unsigned long long)sim->global_cycle);
+
+    for (int c = 0; c < NUM_CORES; c++) {
+        Core *core = &sim->cores[c];
+        fprintf(fp, "    {\n      \"core\": %d,\n", c);
+        // Base stats first so a single file carries the whole picture
+        fprintf(fp, "      \"cycles\": %llu,\n", (unsigned long long)core->cycles);
+        fprintf(fp, "      \"instructions\": %llu,\n", (unsigned long long)core->instructions);
+        fprintf(fp, "      \"read_hit\": %llu,\n", (unsigned long long)core->read_hit);
+        fprintf(fp, "      \"write_hit\": %llu,\n", (unsigned long long)core->write_hit);
+        fprintf(fp, "      \"read_miss\": %llu,\n", (unsigned long long)core->read_miss);
+        fprintf(fp, "      \"write_miss\": %llu,\n", (unsigned long long)core->write_miss);
+        fprintf(fp, "      \"decode_stall\": %llu,\n", (unsigned long long)core->decode_stall);
+        fprintf(fp, "      \"mem_stall\": %llu", (unsigned long long)core->mem_stall);
+        for (int i = 0; i < CORE_PERF_NUM; i++) {
+            fprintf(fp, ",\n      \"%s\": %llu", CORE_PERF_NAMES[i], (unsigned long long)core->perf[i]);
+        }
+        fprintf(fp, "\n    }%s\n", (c < NUM_CORES - 1) ? "," : "");
+    }
+
+    fprintf(fp, "  ],\n  \"bus\": {\n");
+    for (int i = 0; i < BUS_PERF_NUM; i++) {
+        fprintf(fp, "    \"%s\": %llu%s\n", BUS_PERF_NAMES[i],
+                (unsigned long long)sim->bus.perf[i], (i < BUS_PERF_NUM - 1) ? "," : "");
+    }
+    fprintf(fp, "  }\n}\n");
+
+    fclose(fp);
+    return true;
+}
+
+#else
+
+bool save_perf_stats(const char *filename, Core *core) { return true; }
+bool save_bus_perf_stats(const char *filename, BusArbiter *bus) { return true; }
+bool save_perf_json(const char *filename, Simulator *sim) { return true; }
+
+#endif // PERF_COUNTERS
+
+// ====================================================================================
+// BUS QUEUEING / ARBITRATION REPORT
+// ====================================================================================
+
+static const char *BUS_UTIL_NAMES[BUS_UTIL_NUM] = {
+    "busrd_memory", "busrd_cache", "busrdx_memory", "busrdx_cache"
+};
+
+// Nearest-rank percentile over the delay histogram
+static uint64_t queue_percentile(const BusQueueStats *q, double pct) {
+    if (q->requests == 0) return 0;
+    uint64_t rank = (uint64_t)(pct * q->requests + 0.999999);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int d = 0; d < BUS_QUEUE_HIST_SIZE; d++) {
+        seen += q->hist[d];
+        if (seen >= rank) return (d == BUS_QUEUE_HIST_SIZE - 1) ? q->max_delay : (uint64_t)d;
+    }
+    return q->max_delay;
+}
+
+bool save_bus_queue_report(const char *filename, BusArbiter *bus, uint64_t total_cycles) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "# Bus queueing delay: cycles from entering pending[] to arbitration grant\n");
+    fprintf(fp, "# Starvation: a request waited >= %llu cycles\n", (unsigned long long)bus->starvation_threshold);
+    fprintf(fp, "core requests mean p50 p95 p99 max starvation\n");
+    for (int i = 0; i < NUM_CORES; i++) {
+        BusQueueStats *q = &bus->queue[i];
+        fprintf(fp, "%d %llu %.2f %llu %llu %llu %llu %llu\n", i,
+                (unsigned long long)q->requests,
+                q->requests ? (double)q->total_delay / (double)q->requests : 0.0,
+                (unsigned long long)queue_percentile(q, 0.50),
+                (unsigned long long)queue_percentile(q, 0.95),
+                (unsigned long long)queue_percentile(q, 0.99),
+                (unsigned long long)q->max_delay,
+                (unsigned long long)q->starved);
+    }
+
+    fprintf(fp, "\n# Bus utilization by transaction type (grant through last flush word)\n");
+    fprintf(fp, "type transactions cycles utilization\n");
+    uint64_t busy = 0, transactions = 0;
+    for (int t = 0; t < BUS_UTIL_NUM; t++) {
+        busy += bus->util_cycles[t];
+        transactions += bus->util_count[t];
+        fprintf(fp, "%s %llu %llu %.4f\n", BUS_UTIL_NAMES[t],
+                (unsigned long long)bus->util_count[t],
+                (unsigned long long)bus->util_cycles[t],
+                total_cycles ? (double)bus->util_cycles[t] / (double)total_cycles : 0.0);
+    }
+    fprintf(fp, "total %llu %llu %.4f\n",
+            (unsigned long long)transactions,
+            (unsigned long long)busy,
+            total_cycles ? (double)busy / (double)total_cycles : 0.0);
+
+    fprintf(fp, "\n# Delay histogram (core delay count), last bucket is >= %d\n", BUS_QUEUE_HIST_SIZE - 1);
+    for (int i = 0; i < NUM_CORES; i++) {
+        for (int d = 0; d < BUS_QUEUE_HIST_SIZE; d++) {
+            if (bus->queue[i].hist[d]) fprintf(fp, "%d %d %u\n", i, d, bus->queue[i].hist[d]);
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
@@ -0,0 +1,165 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define THREAD_LOCAL __declspec(thread)
+#define ATOMIC_FETCH_INC(p) (_InterlockedIncrement((volatile long *)(p)) - 1)
+#if defined(_M_X64) || defined(_M_IX86)
+#define HAVE_RDTSC 1
+#endif
+#else
+#define THREAD_LOCAL _Thread_local
+#define ATOMIC_FETCH_INC(p) __sync_fetch_and_add((p), 1)
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+#endif
+
+// ====================================================================================
+// HOST SELF-PROFILING (--self-profile)
+// Each thread accumulates into its own slot without locking; the report sums the
+// slots after the run. Ticks are rdtsc where available, otherwise steady-clock ns,
+// and are converted to seconds against the wall clock at report time.
+// ====================================================================================
+
+typedef struct {
+    uint64_t ticks[PROF_NUM_PHASES];
+    uint64_t calls[PROF_NUM_PHASES];
+} ProfileData;
+
+#define PROFILE_PHASE_NAME(id, name) name,
+
+static const char *PHASE_NAMES[PROF_NUM_PHASES] = {
+    PROFILE_PHASE_LIST(PROFILE_PHASE_NAME)
+};
+
+bool profile_enabled = false;
+
+static ProfileData slots[PROFILE_MAX_THREADS];
+static volatile long next_slot = 0;
+static THREAD_LOCAL ProfileData *local_slot = NULL;
+
+// Throughput-over-time samples
+static struct {
+    uint64_t cycle;
+    double wall;
+} samples[PROFILE_MAX_SAMPLES];
+static int num_samples = 0;
+static uint64_t sample_interval = PROFILE_SAMPLE_INTERVAL;
+static uint64_t next_sample_cycle = 0;
+
+static uint64_t start_ticks;
+static double start_wall;
+
+static double wall_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+uint64_t profile_now(void) {
+#ifdef HAVE_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t)(wall_seconds() * 1e9);
+#endif
+}
+
+void profile_add(ProfilePhase phase, uint64_t ticks) {
+    if (!local_slot) {
+        long idx = ATOMIC_FETCH_INC(&next_slot);
+        // Threads beyond the slot count share the last slot (counts may race, never crash)
+        local_slot = &slots[idx < PROFILE_MAX_THREADS ? idx : PROFILE_MAX_THREADS - 1];
+    }
+    local_slot->ticks[phase] += ticks;
+    local_slot->calls[phase]++;
+}
+
+void profile_start(void) {
+    memset(slots, 0, sizeof(slots));
+    num_samples = 0;
+    sample_interval = PROFILE_SAMPLE_INTERVAL;
+    next_sample_cycle = 0;
+    start_wall = wall_seconds();
+    start_ticks = profile_now();
+}
+
+// Called once per simulated cycle while profiling; records wall time every
+// sample_interval cycles, halving the resolution when the buffer fills
+void profile_sample(uint64_t sim_cycle) {
+    if (sim_cycle < next_sample_cycle) return;
+
+    if (num_samples == PROFILE_MAX_SAMPLES) {
+        for (int i = 0; i < PROFILE_MAX_SAMPLES / 2; i++) samples[i] = samples[i * 2];
+        num_samples = PROFILE_MAX_SAMPLES / 2;
+        sample_interval *= 2;
+    }
+    samples[num_samples].cycle = sim_cycle;
+    samples[num_samples].wall = wall_seconds();
+    num_samples++;
+    next_sample_cycle = sim_cycle + sample_interval;
+}
+
+void profile_report(FILE *fp) {
+    double total_wall = wall_seconds() - start_wall;
+    uint64_t total_ticks = profile_now() - start_ticks;
+    double ticks_per_sec = (total_wall > 0) ? (double)total_ticks / total_wall : 1e9;
+
+    ProfileData sum;
+    memset(&sum, 0, sizeof(sum));
+    for (int t = 0; t < PROFILE_MAX_THREADS; t++) {
+        for (int p = 0; p < PROF_NUM_PHASES; p++) {
+            sum.ticks[p] += slots[t].ticks[p];
+            sum.calls[p] += slots[t].calls[p];
+        }
+    }
+
+    fprintf(fp, "\n=== Self-profile (host time) ===\n");
+    fprintf(fp, "Total wall time: %.3f s\n", total_wall);
+    fprintf(fp, "%-22s %10s %8s %12s %10s\n", "phase", "seconds", "% total", "calls", "ns/call");
+    for (int p = 0; p < PROF_NUM_PHASES; p++) {
+        double sec = (double)sum.ticks[p] / ticks_per_sec;
+        fprintf(fp, "%-22s %10.4f %7.2f%% %12llu %10.1f\n", PHASE_NAMES[p], sec,
+                total_wall > 0 ? 100.0 * sec / total_wall : 0.0,
+                (unsigned long long)sum.calls[p],
+                sum.calls[p] ? sec * 1e9 / (double)sum.calls[p] : 0.0);
+    }
+    fprintf(fp, "(phases are inclusive: cache_snoop and add_bus_trace_entry are part of bus_cycle,\n"
+                " save_trace/bustrace is part of save_outputs)\n");
+
+    double trace_sec = (double)(sum.ticks[PROF_CORE_TRACE] + sum.ticks[PROF_BUS_TRACE] +
+                                sum.ticks[PROF_SAVE_TRACES]) / ticks_per_sec;
+    fprintf(fp, "Trace I/O (formatting + writing): %.4f s, %.2f%% of total\n", trace_sec,
+            total_wall > 0 ? 100.0 * trace_sec / total_wall : 0.0);
+
+    if (num_samples > 1) {
+        fprintf(fp, "Simulated cycles/s over time:\n");
+        for (int i = 1; i < num_samples; i++) {
+            double dt = samples[i].wall - samples[i - 1].wall;
+            uint64_t dc = samples[i].cycle - samples[i - 1].cycle;
+            fprintf(fp, "  cycles %8llu - %8llu: %12.0f cycles/s\n",
+                    (unsigned long long)samples[i - 1].cycle,
+                    (unsigned long long)samples[i].cycle - 1,
+                    dt > 0 ? (double)dc / dt : 0.0);
+        }
+    }
+}
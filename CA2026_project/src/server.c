@@ -0,0 +1,368 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simlib.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fileno _fileno
+#define fdopen _fdopen
+#else
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+// ====================================================================================
+// SERVER MODE
+// One simulator instance serves a stream of jobs, so a test farm pays for
+// process start-up and the arena mapping once. Between jobs only the state a
+// job touched is cleared (dirty main memory pages; see init_main_memory).
+//
+// Line protocol (one command per line; blank lines and '#' comments ignored):
+//   imem N FILE          load core N's instruction memory from FILE
+//   imem N - COUNT       ... from the COUNT lines that follow (imemN.txt format)
+//   memin FILE           load main memory from FILE
+//   memin - COUNT        ... from the COUNT lines that follow (memin.txt format)
+//   warm DIR             memory and caches from DIR's memout/dsramN/tsramN (after memin)
+//   run [MAX_CYCLES]     run the job (default: the CLI's cycle cap)
+//   save DIR             write the 22 output files (and enabled reports) into DIR
+//   mem ADDR [COUNT]     main memory words (hex address)
+//   reset                start a new job (implicit on the first load after a run)
+//   quit                 end the session; shutdown also stops a socket server
+//
+// Every command answers with zero or more data lines and then "ok ..." or
+// "error MESSAGE". run streams:
+//   cycles N
+//   core I cycles C instructions N read_hit N write_hit N read_miss N write_miss N decode_stall N mem_stall N
+//   regs I R2 .. R15            (8 hex digits each)
+//   ok run done|limit|mismatch     (mismatch: --cosim, details on stderr)
+// ====================================================================================
+
+#define SERVER_LINE_SIZE 4096
+
+static const char *OUTPUT_NAMES[22] = {
+    "memout.txt", "regout0.txt", "regout1.txt", "regout2.txt", "regout3.txt",
+    "core0trace.txt", "core1trace.txt", "core2trace.txt", "core3trace.txt", "bustrace.txt",
+    "dsram0.txt", "dsram1.txt", "dsram2.txt", "dsram3.txt",
+    "tsram0.txt", "tsram1.txt", "tsram2.txt", "tsram3.txt",
+    "stats0.txt", "stats1.txt", "stats2.txt", "stats3.txt"
+};
+
+typedef struct {
+    Simulator *sim;
+    FILE *in;
+    FILE *out;
+    bool ran;               // The current job has run; the next load starts a new job
+} ServerSession;
+
+// fgets without the line terminator; false at end of input
+static bool read_line(FILE *in, char *line, size_t size) {
+    if (!fgets(line, (int)size, in)) return false;
+    line[strcspn(line, "\r\n")] = '\0';
+    return true;
+}
+
+static char* next_token(char **cursor) {
+    char *p = *cursor + strspn(*cursor, " \t");
+    if (!*p) return NULL;
+    char *end = p + strcspn(p, " \t");
+    if (*end) *end++ = '\0';
+    *cursor = end;
+    return p;
+}
+
+// Rest of the line with surrounding blanks removed (file names may hold spaces)
+static char* rest_of_line(char **cursor) {
+    char *p = *cursor + strspn(*cursor, " \t");
+    size_t n = strlen(p);
+    while (n && (p[n - 1] == ' ' || p[n - 1] == '\t')) p[--n] = '\0';
+    return n ? p : NULL;
+}
+
+// The COUNT lines of an inline image, newline-separated; NULL if input ends early
+static char* read_inline_block(FILE *in, long count, size_t *len) {
+    size_t cap = 4096, used = 0;
+    char *text = (char *)malloc(cap);
+    char line[SERVER_LINE_SIZE];
+    if (!text) return NULL;
+    for (long i = 0; i < count; i++) {
+        if (!read_line(in, line, sizeof(line))) {
+            free(text);
+            return NULL;
+        }
+        size_t n = strlen(line);
+        if (used + n + 1 > cap) {
+            while (used + n + 1 > cap) cap *= 2;
+            char *grown = (char *)realloc(text, cap);
+            if (!grown) {
+                free(text);
+                return NULL;
+            }
+            text = grown;
+        }
+        memcpy(text + used, line, n);
+        text[used + n] = '\n';
+        used += n + 1;
+    }
+    *len = used;
+    return text;
+}
+
+// A load after a run starts a new job; false if the reset failed (the next load retries it)
+static bool begin_load(ServerSession *s) {
+    if (s->ran) {
+        if (!simlib_reset(s->sim)) return false;
+        s->ran = false;
+    }
+    return true;
+}
+
+// imem N FILE | imem N - COUNT | memin FILE | memin - COUNT
+static void handle_load(ServerSession *s, bool is_imem, char *args) {
+    int core_id = 0;
+    if (is_imem) {
+        char *core = next_token(&args);
+        char *end = NULL;
+        if (core) core_id = (int)strtol(core, &end, 10);
+        if (!core || *end || core_id < 0 || core_id >= NUM_CORES) {
+            fprintf(s->out, "error imem needs a core number 0..%d\n", NUM_CORES - 1);
+            return;
+        }
+    }
+    char *source = rest_of_line(&args);
+    if (!source) {
+        fprintf(s->out, "error missing file name or '- COUNT'\n");
+        return;
+    }
+    bool ready = begin_load(s);
+
+    if (source[0] == '-' && (source[1] == ' ' || source[1] == '\t')) {
+        long count = strtol(source + 2, NULL, 10);
+        if (count < 0 || count > (is_imem ? IMEM_SIZE : MAIN_MEM_SIZE)) {
+            fprintf(s->out, "error bad line count\n");
+            return;
+        }
+        size_t len = 0;
+        char *text = read_inline_block(s->in, count, &len);
+        if (!text) {
+            fprintf(s->out, "error inline image ended early\n");
+            return;
+        }
+        if (!ready) {
+            free(text);     // Consumed, so the protocol stays in step
+            fprintf(s->out, "error reset for a new job failed (details on stderr)\n");
+            return;
+        }
+        if (is_imem) simlib_load_program_text(s->sim, core_id, text, len);
+        else simlib_load_memory_text(s->sim, text, len);
+        free(text);
+    } else if (!ready) {
+        fprintf(s->out, "error reset for a new job failed (details on stderr)\n");
+        return;
+    } else {
+        bool ok = is_imem ? load_imem(source, s->sim->cores[core_id].imem)
+                          : load_memin(source, &s->sim->main_memory);
+        if (!ok) {
+            fprintf(s->out, "error could not load %s\n", source);
+            return;
+        }
+    }
+    fprintf(s->out, "ok\n");
+}
+
+static void handle_warm(ServerSession *s, char *args) {
+    char *dir = rest_of_line(&args);
+    if (!dir) {
+        fprintf(s->out, "error warm needs a directory\n");
+        return;
+    }
+    if (!begin_load(s)) fprintf(s->out, "error reset for a new job failed (details on stderr)\n");
+    else if (simlib_warm_start(s->sim, dir)) fprintf(s->out, "ok\n");
+    else fprintf(s->out, "error warm start from %s failed (details on stderr)\n", dir);
+}
+
+static void handle_run(ServerSession *s, char *args) {
+    char *arg = next_token(&args);
+    uint64_t max_cycles = arg ? strtoull(arg, NULL, 10) : (uint64_t)MAX_SIM_CYCLES + 1;
+    Simulator *sim = s->sim;
+
+    SimStopReason reason = simlib_run_until(sim, NULL, NULL, max_cycles);
+    bus_sync_flush(sim);
+    s->ran = true;
+
+    fprintf(s->out, "cycles %llu\n", (unsigned long long)sim->global_cycle);
+    for (int i = 0; i < NUM_CORES; i++) {
+        Core *core = &sim->cores[i];
+        fprintf(s->out, "core %d cycles %llu instructions %llu read_hit %llu write_hit %llu read_miss %llu "
+                "write_miss %llu decode_stall %llu mem_stall %llu\n", i,
+                (unsigned long long)core->cycles, (unsigned long long)core->instructions,
+                (unsigned long long)core->read_hit, (unsigned long long)core->write_hit,
+                (unsigned long long)core->read_miss, (unsigned long long)core->write_miss,
+                (unsigned long long)core->decode_stall, (unsigned long long)core->mem_stall);
+    }
+    for (int i = 0; i < NUM_CORES; i++) {
+        fprintf(s->out, "regs %d", i);
+        for (int r = 2; r < NUM_REGISTERS; r++) fprintf(s->out, " %08X", sim->cores[i].registers[r]);
+        fprintf(s->out, "\n");
+    }
+    fprintf(s->out, "ok run %s\n", reason == SIM_STOP_DONE ? "done" :
+                                    reason == SIM_STOP_MISMATCH ? "mismatch" : "limit");
+}
+
+static void handle_save(ServerSession *s, char *args) {
+    char *dir = rest_of_line(&args);
+    if (!dir) {
+        fprintf(s->out, "error save needs a directory\n");
+        return;
+    }
+    char paths[22][1024];
+    const char *files[27] = { NULL };
+    for (int i = 0; i < 22; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "%s/%s", dir, OUTPUT_NAMES[i]);
+        files[5 + i] = paths[i];
+    }
+    if (simlib_save_outputs(s->sim, files)) fprintf(s->out, "ok\n");
+    else fprintf(s->out, "error could not write outputs to %s\n", dir);
+}
+
+static void handle_mem(ServerSession *s, char *args) {
+    char *addr_arg = next_token(&args);
+    char *count_arg = next_token(&args);
+    if (!addr_arg) {
+        fprintf(s->out, "error mem needs an address\n");
+        return;
+    }
+    uint32_t addr = (uint32_t)strtoul(addr_arg, NULL, 16);
+    long count = count_arg ? strtol(count_arg, NULL, 10) : 1;
+    if (count < 1 || count > MAIN_MEM_SIZE) count = 1;
+    for (long i = 0; i < count; i++) {
+        fprintf(s->out, "%08X\n", simlib_read_memory(s->sim, addr + (uint32_t)i));
+    }
+    fprintf(s->out, "ok\n");
+}
+
+// Serve commands until quit/shutdown or end of input; true on shutdown
+static bool serve_session(ServerSession *s) {
+    char line[SERVER_LINE_SIZE];
+    while (read_line(s->in, line, sizeof(line))) {
+        char *cursor = line;
+        char *cmd = next_token(&cursor);
+        if (!cmd || cmd[0] == '#') continue;
+
+        if (strcmp(cmd, "imem") == 0) handle_load(s, true, cursor);
+        else if (strcmp(cmd, "memin") == 0) handle_load(s, false, cursor);
+        else if (strcmp(cmd, "warm") == 0) handle_warm(s, cursor);
+        else if (strcmp(cmd, "run") == 0) handle_run(s, cursor);
+        else if (strcmp(cmd, "save") == 0) handle_save(s, cursor);
+        else if (strcmp(cmd, "mem") == 0) handle_mem(s, cursor);
+        else if (strcmp(cmd, "reset") == 0) {
+            if (simlib_reset(s->sim)) {
+                s->ran = false;
+                fprintf(s->out, "ok\n");
+            } else {
+                s->ran = true;      // Retried by the next load
+                fprintf(s->out, "error reset failed (details on stderr)\n");
+            }
+        } else if (strcmp(cmd, "quit") == 0 || strcmp(cmd, "shutdown") == 0) {
+            fprintf(s->out, "ok\n");
+            fflush(s->out);
+            return strcmp(cmd, "shutdown") == 0;
+        } else {
+            fprintf(s->out, "error unknown command %s\n", cmd);
+        }
+        fflush(s->out);
+    }
+    return false;
+}
+
+#ifndef _WIN32
+static int serve_socket(ServerSession *s, const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: Socket path too long: %s\n", socket_path);
+        return 1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fprintf(stderr, "Error: Could not create socket\n");
+        return 1;
+    }
+    unlink(socket_path);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listener, 4) != 0) {
+        fprintf(stderr, "Error: Could not listen on %s\n", socket_path);
+        close(listener);
+        return 1;
+    }
+    fprintf(stderr, "Listening on %s\n", socket_path);
+
+    // One client at a time; each connection starts with a fresh job
+    bool shutdown = false;
+    while (!shutdown) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) continue;
+        int out_fd = dup(fd);
+        s->in = fdopen(fd, "r");
+        s->out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+        if (s->in && s->out) {
+            if (s->ran && simlib_reset(s->sim)) s->ran = false;
+            shutdown = serve_session(s);
+        }
+        if (s->in) fclose(s->in);
+        else close(fd);
+        if (s->out) fclose(s->out);
+        else if (out_fd >= 0) close(out_fd);
+    }
+    close(listener);
+    unlink(socket_path);
+    return 0;
+}
+#endif
+
+// socket_path NULL: serve stdin/stdout
+int run_server(const SimOptions *options, const char *socket_path) {
+    ServerSession session;
+    memset(&session, 0, sizeof(session));
+    session.sim = simlib_create(options);
+    if (!session.sim) {
+        fprintf(stderr, "Error: Failed to allocate memory for simulator\n");
+        return 1;
+    }
+
+    int status = 0;
+    if (socket_path) {
+#ifdef _WIN32
+        fprintf(stderr, "Error: --server-socket is not supported on Windows; use --server\n");
+        status = 1;
+#else
+        status = serve_socket(&session, socket_path);
+#endif
+    } else {
+        // Responses get their own handle on stdout; progress messages printed
+        // by the loaders go to stderr so they cannot corrupt the stream
+        fflush(stdout);
+        int out_fd = dup(fileno(stdout));
+        session.out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+        if (!session.out) {
+            fprintf(stderr, "Error: Could not open the response stream\n");
+            simlib_destroy(session.sim);
+            return 1;
+        }
+        dup2(fileno(stderr), fileno(stdout));
+        session.in = stdin;
+        serve_session(&session);
+        fclose(session.out);
+    }
+
+    simlib_destroy(session.sim);
+    return status;
+}
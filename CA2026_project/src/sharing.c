@@ -0,0 +1,195 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// FALSE-SHARING / PING-PONG DETECTOR (--sharing-report)
+// Per-block coherence history over the whole run:
+// - cache_snoop counts BusRdX invalidations and Modified -> Shared downgrades;
+// - cache_fill_block charges the bus cycles of the transaction (grant through
+//   last flush word) to the block if it was coherence traffic: it invalidated
+//   or downgraded another copy, or refetched a copy lost to an invalidation;
+// - stage_memory records which words each core loads and stores, and counts a
+//   transfer whenever a store comes from a core other than the previous writer.
+// A block with coherence traffic is false sharing when no word stored by one
+// core is touched by another, and bouncing (ping-pong) when its writer changed
+// at least SHARING_PINGPONG_MIN times. Word masks cover the whole run, so a
+// block reused for other data in a later phase can show up as true sharing.
+// ====================================================================================
+
+bool sharing_init(SharingTracker *st) {
+    memset(st, 0, sizeof(SharingTracker));
+    st->blocks = (SharingBlock *)calloc(SHARING_NUM_BLOCKS, sizeof(SharingBlock));
+    if (!st->blocks) {
+        fprintf(stderr, "Error: Out of memory for the sharing detector\n");
+        return false;
+    }
+    st->enabled = true;
+    return true;
+}
+
+void sharing_free(SharingTracker *st) {
+    free(st->blocks);
+    memset(st, 0, sizeof(SharingTracker));
+}
+
+static inline SharingBlock* sharing_block(SharingTracker *st, uint32_t addr) {
+    return &st->blocks[(addr & (MAIN_MEM_SIZE - 1)) >> 3];
+}
+
+// core_id holds addr's block in state and snoops the bus owner's command
+void sharing_snoop(Simulator *sim, int core_id, uint32_t addr, BusCommand cmd, MESIState state) {
+    SharingTracker *st = &sim->sharing;
+    SharingBlock *b = sharing_block(st, addr);
+    if (cmd == BUS_RDX) {
+        b->invalidations++;
+        b->lost |= (uint8_t)(1u << core_id);
+        st->coherent = true;
+    } else if (cmd == BUS_RD && state == MESI_MODIFIED) {
+        b->downgrades++;
+        st->coherent = true;
+    }
+}
+
+// The bus owner's fill of block_addr committed
+void sharing_fill(Simulator *sim, int core_id, uint32_t block_addr) {
+    SharingTracker *st = &sim->sharing;
+    SharingBlock *b = sharing_block(st, block_addr);
+    if (b->lost & (1u << core_id)) {
+        b->lost &= (uint8_t)~(1u << core_id);
+        st->coherent = true;
+    }
+    if (st->coherent) {
+        b->cost += sim->global_cycle - sim->bus.grant_time + 1;
+        b->transactions++;
+        st->coherent = false;
+    }
+}
+
+// A LW/SW of core_id performed (hit) on addr
+void sharing_access(Simulator *sim, int core_id, uint32_t addr, bool is_write) {
+    SharingBlock *b = sharing_block(&sim->sharing, addr);
+    uint8_t word = (uint8_t)(1u << (addr & 0x7));
+    if (!is_write) {
+        b->read_mask[core_id] |= word;
+        return;
+    }
+    b->write_mask[core_id] |= word;
+    if (b->last_writer != core_id + 1) {
+        if (b->last_writer) b->transfers++;
+        b->last_writer = (uint8_t)(core_id + 1);
+    }
+}
+
+// ====================================================================================
+// REPORT
+// ====================================================================================
+
+typedef struct {
+    uint32_t block;
+    uint64_t cost;
+} SharingRank;
+
+static int compare_rank(const void *a, const void *b) {
+    const SharingRank *x = (const SharingRank *)a, *y = (const SharingRank *)b;
+    if (x->cost != y->cost) return x->cost > y->cost ? -1 : 1;
+    return x->block < y->block ? -1 : (x->block > y->block);
+}
+
+// True if some word stored by one core is loaded or stored by another
+static bool words_shared(const SharingBlock *b) {
+    for (int i = 0; i < NUM_CORES; i++) {
+        uint8_t others = 0;
+        for (int j = 0; j < NUM_CORES; j++) {
+            if (j != i) others |= b->read_mask[j] | b->write_mask[j];
+        }
+        if (b->write_mask[i] & others) return true;
+    }
+    return false;
+}
+
+static void write_block_line(FILE *fp, int rank, uint32_t block, const SharingBlock *b) {
+    char sharers[NUM_CORES + 1];
+    int n = 0;
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (b->read_mask[i] | b->write_mask[i]) sharers[n++] = (char)('0' + i);
+    }
+    sharers[n] = '\0';
+
+    char kind[32];
+    sprintf(kind, "%s%s", words_shared(b) ? "true" : "false",
+            b->transfers >= SHARING_PINGPONG_MIN ? "+pingpong" : "");
+
+    fprintf(fp, "%4d  %06X %9llu %6u %6u %6u %6u  %-7s  %-14s", rank, block, (unsigned long long)b->cost,
+            b->transactions, b->invalidations, b->transfers, b->downgrades, n ? sharers : "-", kind);
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (!(b->read_mask[i] | b->write_mask[i])) continue;
+        char words[CACHE_BLOCK_SIZE + 1];
+        for (int w = 0; w < CACHE_BLOCK_SIZE; w++) {
+            bool r = b->read_mask[i] & (1u << w), wr = b->write_mask[i] & (1u << w);
+            words[w] = r && wr ? 'B' : wr ? 'W' : r ? 'R' : '.';
+        }
+        words[CACHE_BLOCK_SIZE] = '\0';
+        fprintf(fp, " %d:%s", i, words);
+    }
+    fprintf(fp, "\n");
+}
+
+bool save_sharing_report(const char *filename, Simulator *sim) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    const SharingBlock *blocks = sim->sharing.blocks;
+    int count = 0;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < SHARING_NUM_BLOCKS; i++) {
+        if (blocks[i].transactions || blocks[i].transfers) count++;
+    }
+    SharingRank *ranks = (SharingRank *)malloc((size_t)(count ? count : 1) * sizeof(SharingRank));
+    if (!ranks) {
+        fprintf(stderr, "Error: Out of memory for the sharing report\n");
+        fclose(fp);
+        return false;
+    }
+    int n = 0;
+    for (uint32_t i = 0; i < SHARING_NUM_BLOCKS; i++) {
+        if (!blocks[i].transactions && !blocks[i].transfers) continue;
+        ranks[n].block = i << 3;
+        ranks[n].cost = blocks[i].cost;
+        total += blocks[i].cost;
+        n++;
+    }
+    qsort(ranks, (size_t)n, sizeof(SharingRank), compare_rank);
+
+    uint64_t busy = 0;
+    for (int t = 0; t < BUS_UTIL_NUM; t++) busy += sim->bus.util_cycles[t];
+
+    fprintf(fp, "# Coherence sharing report, %llu cycles\n", (unsigned long long)sim->global_cycle);
+    fprintf(fp, "# Blocks with coherence traffic: %d, %llu bus cycles (%.1f%% of bus busy cycles)\n", n,
+            (unsigned long long)total, busy ? 100.0 * (double)total / (double)busy : 0.0);
+    fprintf(fp, "# cost     bus cycles of transactions that invalidated or downgraded a copy, or refetched a lost one\n");
+    fprintf(fp, "# trans    those transactions\n");
+    fprintf(fp, "# inval    copies invalidated by BusRdX\n");
+    fprintf(fp, "# xfer     stores by a core other than the previous writer\n");
+    fprintf(fp, "# down     Modified -> Shared downgrades\n");
+    fprintf(fp, "# kind     false: no word stored by one core is touched by another, true otherwise;\n");
+    fprintf(fp, "#          +pingpong: xfer >= %d\n", SHARING_PINGPONG_MIN);
+    fprintf(fp, "# words    per core, words 0-7: R loaded, W stored, B both, . untouched\n\n");
+
+    fprintf(fp, "rank  block       cost  trans  inval   xfer   down  sharers  kind            words\n");
+    for (int r = 0; r < n && r < SHARING_REPORT_MAX; r++) {
+        write_block_line(fp, r + 1, ranks[r].block, &blocks[ranks[r].block >> 3]);
+    }
+    if (n > SHARING_REPORT_MAX) fprintf(fp, "(%d more blocks)\n", n - SHARING_REPORT_MAX);
+
+    free(ranks);
+    fclose(fp);
+    return true;
+}
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 
 /* ============================================
  * CONSTANTS AND CONFIGURATION
@@ -18,6 +20,27 @@
 #define MAIN_MEM_LATENCY 16     // cycles for first word
 #define MAX_TRACE_LINES 100000  // Maximum trace lines per core/bus
 #define TRACE_LINE_SIZE 512     // Size of each trace line
+#define MAX_SIM_CYCLES 100000   // run_simulator stops after this cycle
+
+// Extended performance counters (perf*.txt / perf.json).
+// Build with -DPERF_COUNTERS=0 to compile every counter update out.
+#ifndef PERF_COUNTERS
+#define PERF_COUNTERS 1
+#endif
+
+// Host self-profiling scopes (--self-profile).
+// Build with -DSIM_PROFILE=0 to compile every scope out.
+#ifndef SIM_PROFILE
+#define SIM_PROFILE 1
+#endif
+
+// Host cache line. Per-cycle state (Core, BusArbiter) starts on its own line.
+#define HOST_CACHE_LINE 64
+#if defined(_MSC_VER)
+#define CACHE_ALIGNED __declspec(align(64))
+#else
+#define CACHE_ALIGNED __attribute__((aligned(HOST_CACHE_LINE)))
+#endif
 
 /* ============================================
  * INSTRUCTION FORMAT AND OPCODES
@@ -55,6 +78,40 @@ typedef enum {
     OP_HALT = 20
 } Opcode;
 
+// ALU result of an instruction: the address for LW/SW, the link value for JAL,
+// 0 for branches, HALT and undefined opcodes. Shared by stage_execute and the
+// functional interpreter (functional.c).
+static inline uint32_t alu_compute(uint8_t opcode, uint32_t rs_val, uint32_t rt_val, uint16_t pc) {
+    switch (opcode) {
+        case OP_ADD: return rs_val + rt_val;
+        case OP_SUB: return rs_val - rt_val;
+        case OP_AND: return rs_val & rt_val;
+        case OP_OR:  return rs_val | rt_val;
+        case OP_XOR: return rs_val ^ rt_val;
+        case OP_MUL: return rs_val * rt_val;
+        case OP_SLL: return rs_val << (rt_val & 0x1F);
+        case OP_SRA: return (uint32_t)((int32_t)rs_val >> (rt_val & 0x1F));
+        case OP_SRL: return rs_val >> (rt_val & 0x1F);
+        case OP_JAL: return (uint32_t)(pc + 2);
+        case OP_LW:
+        case OP_SW:  return rs_val + rt_val;
+        default:     return 0;
+    }
+}
+
+// Condition of a conditional branch (false for every other opcode)
+static inline bool branch_condition(uint8_t opcode, int32_t rs_val, int32_t rt_val) {
+    switch (opcode) {
+        case OP_BEQ: return rs_val == rt_val;
+        case OP_BNE: return rs_val != rt_val;
+        case OP_BLT: return rs_val < rt_val;
+        case OP_BGT: return rs_val > rt_val;
+        case OP_BLE: return rs_val <= rt_val;
+        case OP_BGE: return rs_val >= rt_val;
+        default:     return false;
+    }
+}
+
 /* ============================================
  * MESI CACHE COHERENCY PROTOCOL
  * ============================================ */
@@ -93,21 +150,190 @@ typedef struct {
 } BusTransaction;
 
 /* ============================================
- * CACHE STRUCTURES
+ * PERFORMANCE COUNTER REGISTRY
+ * ============================================ */
+
+// Adding a counter is one line here: X(enum id, output name)
+#define CORE_PERF_COUNTER_LIST(X) \
+    X(PERF_DECODE_STALL_RAW_RS,     "decode_stall_raw_rs")          \
+    X(PERF_DECODE_STALL_RAW_RT,     "decode_stall_raw_rt")          \
+    X(PERF_DECODE_STALL_RAW_RD,     "decode_stall_raw_rd")          \
+    X(PERF_DECODE_STALL_EX_BUSY,    "decode_stall_ex_backpressure") \
+    X(PERF_MEM_STALL_ARBITRATION,   "mem_stall_arbitration")        \
+    X(PERF_MEM_STALL_LATENCY,       "mem_stall_mem_latency")        \
+    X(PERF_MEM_STALL_FLUSH,         "mem_stall_flush_transfer")     \
+    X(PERF_SNOOP_INVALIDATIONS,     "snoop_invalidations")          \
+    X(PERF_SNOOP_DOWNGRADES,        "snoop_downgrades")             \
+    X(PERF_C2C_SUPPLIES,            "cache_to_cache_supplies")
+
+#define BUS_PERF_COUNTER_LIST(X) \
+    X(PERF_BUS_BUSY_CYCLES,         "bus_busy_cycles")              \
+    X(PERF_BUS_IDLE_CYCLES,         "bus_idle_cycles")              \
+    X(PERF_BUS_CMD_RD,              "bus_cmd_busrd")                \
+    X(PERF_BUS_CMD_RDX,             "bus_cmd_busrdx")               \
+    X(PERF_BUS_CMD_FLUSH,           "bus_cmd_flush")                \
+    X(PERF_BUS_MEM_SUPPLIES,        "bus_memory_supplies")          \
+    X(PERF_BUS_C2C_SUPPLIES,        "bus_cache_to_cache_supplies")
+
+#define PERF_COUNTER_ENUM(id, name) id,
+
+typedef enum {
+    CORE_PERF_COUNTER_LIST(PERF_COUNTER_ENUM)
+    CORE_PERF_NUM
+} CorePerfCounter;
+
+typedef enum {
+    BUS_PERF_COUNTER_LIST(PERF_COUNTER_ENUM)
+    BUS_PERF_NUM
+} BusPerfCounter;
+
+#if PERF_COUNTERS
+#define PERF_INC(counters, id) ((counters)[id]++)
+#else
+#define PERF_INC(counters, id) ((void)0)
+#endif
+
+/* ============================================
+ * TRACE CONTROL
  * ============================================ */
 
-// TSRAM entry: tag (12 bits) + MESI state (2 bits)
+// Trace streams: one per core, then the bus
+#define TRACE_STREAM_BUS NUM_CORES
+#define TRACE_NUM_STREAMS (NUM_CORES + 1)
+#define MAX_TRACE_WINDOWS 16
+#define TRACE_DEFAULT_PRE 1000      // Cycles kept before a trigger
+#define TRACE_DEFAULT_POST 1000     // Cycles recorded after a trigger
+
 typedef struct {
-    uint16_t tag;         // bits 11:0
-    MESIState mesi_state; // bits 13:12
-    bool valid;
-} TSRAMEntry;
+    uint64_t start;
+    uint64_t end;                   // Inclusive
+} TraceWindow;
 
-// Cache structure
+// Zero-initialized = trace everything (the required output format)
 typedef struct {
-    uint32_t dsram[CACHE_SIZE];      // Data storage (512 words)
-    TSRAMEntry tsram[NUM_CACHE_BLOCKS]; // Tag + MESI state (64 entries)
+    uint32_t disabled_streams;      // Bit per stream (--trace / --no-trace)
+    int num_windows;                // --trace-window A:B (0 = every cycle)
+    TraceWindow windows[MAX_TRACE_WINDOWS];
+    bool trigger_pc_enabled;        // --trace-trigger-pc [CORE:]PC
+    int trigger_pc_core;            // -1 = any core
+    uint16_t trigger_pc;
+    bool trigger_addr_enabled;      // --trace-trigger-addr ADDR
+    uint32_t trigger_addr;
+    uint32_t pre_cycles;            // --trace-pre N
+    uint32_t post_cycles;           // --trace-post N
+} TraceConfig;
+
+// Pre-trigger ring kept in the stream's own trace buffer, just past trace_count
+typedef struct {
+    int len;
+    int head;                       // Oldest entry once the ring is full
+} TraceRing;
+
+// One core trace line before formatting
+#define TRACE_NO_PC 0xFFFF          // Stage printed as "---"
+typedef struct {
+    uint64_t cycle;
+    uint16_t pc[5];                 // IF, ID, EX, MEM, WB
+    uint32_t regs[NUM_REGISTERS - 2]; // R2-R15
+} CoreTraceRecord;
+
+// Trace fingerprint (--fingerprint): rolling 64-bit hash per stream instead of text
+#define FINGERPRINT_DEFAULT_INTERVAL 1000
+
+typedef struct {
+    uint64_t start_cycle;
+    uint64_t end_cycle;             // Inclusive
+    uint64_t hash[TRACE_NUM_STREAMS];
+} FingerprintCheckpoint;
+
+typedef struct {
+    bool enabled;
+    uint64_t interval;              // Cycles per checkpoint window
+    uint64_t window_start;
+    uint64_t window[TRACE_NUM_STREAMS];   // Hash of the current window
+    uint64_t total[TRACE_NUM_STREAMS];    // Hash of the whole run
+    uint64_t records[TRACE_NUM_STREAMS];
+    FingerprintCheckpoint *checkpoints;   // Grown with realloc
+    int num_checkpoints;
+    int max_checkpoints;
+} TraceFingerprint;
+
+/* ============================================
+ * CACHE STRUCTURES
+ * ============================================ */
+
+// TSRAM entry: the 14-bit hardware word, tag in bits 11:0 and MESI state in
+// bits 13:12. A line is valid exactly when its state is not Invalid.
+typedef uint16_t TSRAMEntry;
+
+#define TSRAM_TAG_MASK    0x0FFF
+#define TSRAM_STATE_SHIFT 12
+
+static inline uint16_t tsram_tag(TSRAMEntry e) { return e & TSRAM_TAG_MASK; }
+static inline MESIState tsram_state(TSRAMEntry e) { return (MESIState)(e >> TSRAM_STATE_SHIFT); }
+static inline bool tsram_valid(TSRAMEntry e) { return (e >> TSRAM_STATE_SHIFT) != MESI_INVALID; }
+
+// Valid line holding `tag` (one compare on the packed word)
+static inline bool tsram_hit(TSRAMEntry e, uint16_t tag) {
+    return tsram_valid(e) && tsram_tag(e) == tag;
+}
+
+static inline TSRAMEntry tsram_make(uint16_t tag, MESIState state) {
+    return (TSRAMEntry)(((unsigned)state << TSRAM_STATE_SHIFT) | (tag & TSRAM_TAG_MASK));
+}
+
+// Change the state, keeping the tag (an invalidated line still reports its tag)
+static inline void tsram_set_state(TSRAMEntry *e, MESIState state) {
+    *e = tsram_make(tsram_tag(*e), state);
+}
+
+/* ============================================
+ * TAG DIRECTORY (TSRAM OF ALL CACHES)
+ * ============================================ */
+
+// The TSRAM of every cache in one set-major array: set i of all caches is a
+// single 64-bit word, with core c's entry in bits 16c+15..16c. One probe
+// answers "which caches hold this block, and in what state" for every core.
+#if NUM_CORES > 4
+#error "TagDirectory packs one 16-bit TSRAM entry per core into 64 bits"
+#endif
+
+#define TAG_LANE_BITS 16
+#define TAG_LANES_ONE 0x0001000100010001ULL   // 1 in every lane
+
+typedef struct {
+    uint64_t sets[NUM_CACHE_BLOCKS];
+} TagDirectory;
+
+static inline TSRAMEntry tag_dir_get(const TagDirectory *dir, int index, int core_id) {
+    return (TSRAMEntry)(dir->sets[index] >> (TAG_LANE_BITS * core_id));
+}
+
+static inline void tag_dir_set(TagDirectory *dir, int index, int core_id, TSRAMEntry e) {
+    int shift = TAG_LANE_BITS * core_id;
+    dir->sets[index] = (dir->sets[index] & ~(0xFFFFULL << shift)) | ((uint64_t)e << shift);
+}
+
+// MESI state of addr's block in every cache, 2 bits per 16-bit lane
+// (MESI_INVALID where the cache does not hold it). SWAR: the tag is compared
+// in all lanes at once, and a lane is a mismatch exactly when adding 0x0FFF to
+// its masked XOR carries into bit 12 (a lane never overflows into the next).
+static inline uint64_t tag_dir_probe(const TagDirectory *dir, uint32_t addr) {
+    uint64_t w = dir->sets[(addr >> 3) & 0x3F];
+    uint64_t tag = (addr >> 9) & TSRAM_TAG_MASK;
+    uint64_t x = (w ^ (TAG_LANES_ONE * tag)) & (TAG_LANES_ONE * TSRAM_TAG_MASK);
+    uint64_t mismatch = ((x + TAG_LANES_ONE * TSRAM_TAG_MASK) >> TSRAM_STATE_SHIFT) & TAG_LANES_ONE;
+    uint64_t states = (w >> TSRAM_STATE_SHIFT) & (TAG_LANES_ONE * 3);
+    return states & ~(mismatch * 3);
+}
 
+static inline MESIState tag_lane_state(uint64_t states, int core_id) {
+    return (MESIState)((states >> (TAG_LANE_BITS * core_id)) & 3);
+}
+
+// Cache structure. The TSRAM lives in the simulator's TagDirectory; the
+// state machine comes first so it shares lines with the core's hot state.
+typedef struct {
     // Pending cache operation state machine
     enum {
         CACHE_IDLE = 0,
@@ -126,6 +352,8 @@ typedef struct {
     bool is_write_miss;        // Distinguish between Rd miss and RdX miss
     int words_received;        // For 8-word transfer
     int words_sent;            // For 8-word transfer
+
+    uint32_t dsram[CACHE_SIZE];      // Data storage (512 words)
 } Cache;
 
 /* ============================================
@@ -171,14 +399,15 @@ typedef struct {
  * CORE STRUCTURE
  * ============================================ */
 
-typedef struct {
-    int core_id;                      // 0-3
-    uint16_t pc;                      // Program counter (10 bits)
+// Hot per-cycle state first (pipeline, registers, control, cache), then the
+// cold tail: statistics, instruction memory and the trace buffer, which lives
+// in the simulator's arena.
+typedef struct CACHE_ALIGNED {
+    Pipeline pipeline;                // 5-stage pipeline
     uint32_t registers[NUM_REGISTERS]; // Register file (R0=0, R1=imm, R2-R15 general)
     uint32_t imm_register;            // R1 special register: sign-extended immediate
-    uint32_t imem[IMEM_SIZE];         // Instruction memory
-    Cache cache;                      // Data cache
-    Pipeline pipeline;                // 5-stage pipeline
+    int core_id;                      // 0-3
+    uint16_t pc;                      // Program counter (10 bits)
 
     bool halted;                      // Has this core executed halt?
     bool halt_fetch;                  // Stop fetching new instructions (HALT in ID)
@@ -197,6 +426,8 @@ typedef struct {
     uint8_t pending_reg_write_addr;
     uint32_t pending_reg_write_val;
 
+    Cache cache;                      // Data cache
+
     // Statistics
     uint64_t cycles;
     uint64_t instructions;
@@ -206,18 +437,30 @@ typedef struct {
     uint64_t write_miss;
     uint64_t decode_stall;
     uint64_t mem_stall;
+#if PERF_COUNTERS
+    uint64_t perf[CORE_PERF_NUM];     // Extended counters (see CORE_PERF_COUNTER_LIST)
+#endif
 
-    // Trace output buffer - fixed size to avoid malloc issues
-    char trace_lines[MAX_TRACE_LINES][TRACE_LINE_SIZE];
+    uint32_t imem[IMEM_SIZE];         // Instruction memory
+
+    // Trace output buffer (MAX_TRACE_LINES lines, allocated from the arena)
+    char (*trace_lines)[TRACE_LINE_SIZE];
     int trace_count;
+    TraceRing trace_ring;
 } Core;
 
 /* ============================================
  * MAIN MEMORY STRUCTURE
  * ============================================ */
 
+#define MEM_PAGE_WORDS 1024     // Dirty-tracking granule (4 KB)
+#define MEM_NUM_PAGES (MAIN_MEM_SIZE / MEM_PAGE_WORDS)
+
 typedef struct {
-    uint32_t data[MAIN_MEM_SIZE];
+    uint32_t *data;           // MAIN_MEM_SIZE words, allocated from the arena
+    // Pages written since the last reset; init_main_memory clears only these.
+    // Every writer of data[] must call memory_mark_dirty().
+    uint64_t dirty[MEM_NUM_PAGES / 64];
 
     // Pending memory transaction
     bool pending;
@@ -226,11 +469,127 @@ typedef struct {
     int words_sent;           // Words already sent in block
 } MainMemory;
 
+/* ============================================
+ * BANKED DRAM TIMING (--dram)
+ * ============================================ */
+
+// Block address = [row][bank][column], bank XOR row: DRAM_ROW_BLOCKS consecutive blocks share a row
+#define DRAM_NUM_BANKS 8
+#define DRAM_ROW_BLOCKS 32      // 1 KB row buffer
+#define DRAM_T_CAS 10           // Row hit: column access to first word
+#define DRAM_T_RCD 8            // Activate a closed bank's row
+#define DRAM_T_RP 8             // Precharge the open row first (row conflict)
+#define DRAM_T_BURST 4          // Bank busy after the first word
+#define DRAM_T_REFI 3900        // Refresh interval
+#define DRAM_T_RFC 100          // Refresh: bank blocked, row closed
+#define DRAM_QUEUE_DEPTH 16     // Per-bank queue
+#define DRAM_NO_ROW 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t row;
+    uint64_t arrival;
+    bool is_write;
+} DramRequest;
+
+typedef struct {
+    uint32_t open_row;              // DRAM_NO_ROW = precharged
+    uint64_t ready;                 // First cycle the bank can start a column access
+    uint64_t next_refresh;
+    DramRequest queue[DRAM_QUEUE_DEPTH];
+    int count;
+} DramBank;
+
+typedef struct {
+    bool enabled;
+    DramBank banks[DRAM_NUM_BANKS];
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t row_hits;
+    uint64_t row_misses;            // Bank precharged: activate only
+    uint64_t row_conflicts;         // Other row open: precharge + activate
+    uint64_t read_latency;          // Sum over reads, bus request to first word
+    uint64_t max_read_latency;
+    uint64_t refresh_delay;         // Cycles accesses waited for a refresh
+} DramModel;
+
+/* ============================================
+ * SHARED LAST-LEVEL CACHE (--llc)
+ * ============================================ */
+
+#define LLC_DEFAULT_WAYS 8
+#define LLC_DEFAULT_LATENCY 8           // Request to first word on an LLC hit
+
+typedef enum {
+    LLC_INCLUSIVE = 0,      // Every memory read fills; evicting a block invalidates its L1 copies
+    LLC_NON_INCLUSIVE,      // Every memory read fills; L1 copies are left alone
+    LLC_EXCLUSIVE           // A hit moves the block to the L1; L1 victims fill the LLC
+} LLCPolicy;
+
+typedef struct {
+    uint32_t block;         // Block number (addr >> 3)
+    uint64_t last_use;      // LRU stamp
+    bool valid;
+    bool dirty;             // DRAM copy is stale
+} LLCLine;
+
+typedef struct {
+    bool enabled;
+    LLCPolicy policy;
+    uint32_t sets;
+    int ways;
+    int latency;
+    LLCLine *lines;         // [sets][ways]
+    uint32_t *data;         // [sets][ways][CACHE_BLOCK_SIZE]
+    uint64_t stamp;
+    uint64_t read_hit;              // Memory-supplied bus reads
+    uint64_t read_miss;
+    uint64_t write_hit;             // Memory updates of cache-to-cache transfers
+    uint64_t write_miss;
+    uint64_t fills;
+    uint64_t evictions;
+    uint64_t writebacks;            // Dirty blocks written to DRAM
+    uint64_t back_invalidations;    // L1 copies dropped by inclusive evictions
+    uint64_t victim_fills;          // L1 victims placed by the exclusive policy
+} SharedLLC;
+
+static inline void memory_mark_dirty(MainMemory *mem, uint32_t addr, uint32_t words) {
+    if (!words) return;
+    uint32_t first = (addr & (MAIN_MEM_SIZE - 1)) / MEM_PAGE_WORDS;
+    uint32_t last = ((addr + words - 1) & (MAIN_MEM_SIZE - 1)) / MEM_PAGE_WORDS;
+    if (last < first) last = MEM_NUM_PAGES - 1;  // Range wraps past the end
+    for (uint32_t p = first; p <= last; p++) mem->dirty[p >> 6] |= 1ULL << (p & 63);
+}
+
 /* ============================================
  * BUS ARBITER STRUCTURE
  * ============================================ */
 
+#define BUS_QUEUE_HIST_SIZE 1024  // Exact per-cycle delay buckets; last bucket collects overflow
+
+// Worst-case wait under fair round-robin: every other core ahead of us (the
+// owner in flight included) runs a full memory-supplied transaction. Waiting
+// longer than this counts as starvation.
+#define BUS_STARVATION_THRESHOLD ((NUM_CORES - 1) * (2 + MAIN_MEM_LATENCY + CACHE_BLOCK_SIZE))
+
+// Queueing delay: cycles between entering pending[] and being granted the bus
 typedef struct {
+    uint32_t hist[BUS_QUEUE_HIST_SIZE];
+    uint64_t requests;
+    uint64_t total_delay;
+    uint64_t max_delay;
+    uint64_t starved;             // Grants after waiting >= the starvation threshold
+} BusQueueStats;
+
+// Transaction types for bus utilization accounting
+typedef enum {
+    BUS_UTIL_RD_MEM = 0,   // BusRd supplied by main memory
+    BUS_UTIL_RD_C2C,       // BusRd supplied by a Modified cache
+    BUS_UTIL_RDX_MEM,      // BusRdX supplied by main memory
+    BUS_UTIL_RDX_C2C,      // BusRdX supplied by a Modified cache
+    BUS_UTIL_NUM
+} BusUtilType;
+
+typedef struct CACHE_ALIGNED {
     BusTransaction current;       // Current bus signals (updated every cycle)
     int last_granted;             // Last core that was granted access (for round-robin)
 
@@ -250,39 +609,531 @@ typedef struct {
     // Pending transactions waiting for bus
     bool pending[NUM_CORES];
     BusTransaction pending_trans[NUM_CORES];
-    uint64_t request_time[NUM_CORES]; 
+    uint64_t request_time[NUM_CORES]; // Cycle each pending request was issued
+    uint64_t grant_time;              // Cycle the current owner was granted
 
-    // Bus trace output - fixed size buffer to avoid malloc issues
-    char trace_lines[MAX_TRACE_LINES][TRACE_LINE_SIZE];
+    // Bus trace output (MAX_TRACE_LINES lines, allocated from the arena)
+    char (*trace_lines)[TRACE_LINE_SIZE];
     int trace_count;
+    TraceRing trace_ring;
+
+    // Queueing / utilization statistics (busqueue.txt)
+    BusQueueStats queue[NUM_CORES];
+    uint64_t starvation_threshold;    // --starvation-threshold, BUS_STARVATION_THRESHOLD by default
+    uint64_t util_cycles[BUS_UTIL_NUM];
+    uint64_t util_count[BUS_UTIL_NUM];
+#if PERF_COUNTERS
+    uint64_t perf[BUS_PERF_NUM];  // Extended counters (see BUS_PERF_COUNTER_LIST)
+#endif
 } BusArbiter;
 
+/* ============================================
+ * MISS CLASSIFICATION (3C + COHERENCE)
+ * ============================================ */
+
+typedef enum {
+    MISS_COMPULSORY = 0,   // First reference to the block
+    MISS_CAPACITY,         // Also misses in a fully-associative LRU cache of the same size
+    MISS_CONFLICT,         // Would hit in the fully-associative cache
+    MISS_COHERENCE_TRUE,   // Block was invalidated and a remote core wrote the accessed word
+    MISS_COHERENCE_FALSE,  // Block was invalidated but only other words were written remotely
+    MISS_UPGRADE,          // SW to a Shared block (BusRdX for ownership only)
+    MISS_CLASS_NUM
+} MissClass;
+
+// Invalidation history for one cache set, filled by cache_snoop
+typedef struct {
+    bool valid;
+    uint32_t block;            // Block base address that was invalidated
+    uint8_t remote_written;    // Words written by other cores since the invalidation
+} MissInvalRecord;
+
+typedef struct {
+    uint32_t shadow[NUM_CACHE_BLOCKS];  // Fully-associative LRU shadow cache, MRU first
+    int shadow_count;
+    uint8_t seen[MAIN_MEM_SIZE / CACHE_BLOCK_SIZE / 8];  // Bitmap of blocks ever referenced
+    MissInvalRecord inval[NUM_CACHE_BLOCKS];
+    bool coherence_pending;    // Coherence miss waiting for its fill to be classified
+    uint16_t coherence_pc;
+    uint64_t total[MISS_CLASS_NUM];
+    uint32_t per_pc[IMEM_SIZE][MISS_CLASS_NUM];
+} MissClassifier;
+
+/* ============================================
+ * CO-SIMULATION CHECKER (--cosim)
+ * ============================================ */
+
+// Architectural state of one core in the ISA reference model
+typedef struct {
+    uint32_t regs[NUM_REGISTERS];
+    uint16_t pc;                    // Next instruction expected to retire
+    uint16_t npc;                   // The one after it (branch delay slot)
+    bool halted;
+    uint64_t retired;
+} CosimCore;
+
+typedef struct {
+    bool enabled;
+    bool started;                   // Memory image taken before the first cycle
+    bool failed;                    // A mismatch was reported; the run stops
+    uint32_t *memory;               // MAIN_MEM_SIZE words, updated in retirement order
+    CosimCore cores[NUM_CORES];
+    uint64_t checked;               // Instructions compared
+} CosimChecker;
+
+/* ============================================
+ * SPIN-LOOP FAST-FORWARD (--spin-ff)
+ * ============================================ */
+
+#define SPIN_MAX_PERIOD 64              // Longest loop (in cycles) that is detected
+#define SPIN_MAX_BLOCKS 4               // Distinct blocks a parked loop may read
+#define SPIN_STATE_BYTES offsetof(Core, cache)  // Per-cycle core state: everything before the cache
+#define SPIN_NUM_COUNTERS (8 + (PERF_COUNTERS ? CORE_PERF_NUM : 0))  // Core statistics (+ perf)
+
+typedef enum {
+    SPIN_IDLE = 0,      // No anchor yet
+    SPIN_SEARCH,        // Waiting for the state to return to the anchor
+    SPIN_RECORD,        // Recording one period of the loop that was found
+    SPIN_PARKED         // Replaying the recorded period
+} SpinMode;
+
+typedef struct {
+    SpinMode mode;
+    int length;                             // Search: cycles since the anchor; record: cycles recorded
+    int period;
+    int phase;                              // Parked: position in the period
+    uint64_t elapsed;                       // Parked: cycles replayed
+    uint8_t state[SPIN_MAX_PERIOD][SPIN_STATE_BYTES];   // [0] = anchor, [k] = state k cycles later
+    CoreTraceRecord rec[SPIN_MAX_PERIOD];   // Trace record of each cycle of the period
+    char text[SPIN_MAX_PERIOD][TRACE_LINE_SIZE];        // The same, formatted after the cycle number
+    int text_len[SPIN_MAX_PERIOD];
+    uint8_t delta[SPIN_MAX_PERIOD][SPIN_NUM_COUNTERS];  // Counter increments of each cycle
+    uint64_t prefix[SPIN_MAX_PERIOD + 1][SPIN_NUM_COUNTERS];  // Running sums of delta
+    uint64_t last[SPIN_NUM_COUNTERS];       // Counters after the previous recorded cycle
+    uint64_t base[SPIN_NUM_COUNTERS];       // Counters when parked
+    uint64_t applied[SPIN_NUM_COUNTERS];    // Loop increments already added to the core
+    uint32_t blocks[SPIN_MAX_BLOCKS];       // Blocks loaded in the period
+    int num_blocks;
+} SpinCore;
+
+typedef struct {
+    bool enabled;
+    SpinCore *cores;                        // NUM_CORES, allocated when enabled
+    uint64_t parks;                         // Loops detected
+    uint64_t replayed;                      // Core-cycles replayed instead of simulated
+} SpinForward;
+
+/* ============================================
+ * FUNCTIONAL EXECUTION (--functional)
+ * ============================================ */
+
+// ISA-level execution without timing (functional.c). Each basic block of IMEM
+// (up to a branch or JAL and its delay slot) is translated once into FuncOps.
+#define FUNC_MAX_BLOCK_INSTS 64         // Instructions in a block before it is split
+#define FUNC_POOL_OPS 4096              // Translated ops per core; the cache is flushed when full
+#define FUNC_QUANTUM 256                // Instructions a core runs before the next core's turn
+#define FUNC_DEFAULT_LIMIT 100000000ULL // Instructions per core before a run is stopped
+
+typedef struct {
+    uint8_t opcode;                 // Opcode, or FUNC_OP_CONST (folded R0/R1 operands)
+    uint8_t rd, rs, rt;
+    uint32_t imm;                   // Sign-extended immediate (R1), or the folded result
+} FuncOp;
+
+typedef enum {
+    FUNC_END_FALL = 0,              // Block split or IMEM end: continue at next_pc
+    FUNC_END_HALT,                  // Ends with HALT
+    FUNC_END_BRANCH,                // Branch/JAL, then its delay slot
+    FUNC_END_BRANCH_SLOW            // Branch/JAL whose delay slot is itself a control instruction
+} FuncBlockEnd;
+
+typedef struct {
+    uint16_t first;                 // First op in the pool
+    uint8_t num_body;               // Straight-line ops before the end
+    uint8_t num_slot;               // Delay-slot ops after the branch op (0 or 1)
+    uint8_t num_insts;              // Instructions covered, 0 = not translated
+    uint8_t end;                    // FuncBlockEnd
+    uint16_t next_pc;               // Fall-through PC (past the delay slot)
+} FuncBlock;
+
+typedef struct {
+    uint32_t x[NUM_REGISTERS];      // Registers; x[0] = 0, x[1] = immediate of the current op
+    uint16_t pc;
+    uint16_t npc;                   // Next PC (differs from pc + 1 inside a delay slot)
+    bool halted;
+    bool stuck;                     // PC ran past the end of IMEM
+    uint64_t retired;
+
+    FuncBlock blocks[IMEM_SIZE];    // Translation cache, indexed by start PC
+    FuncOp ops[FUNC_POOL_OPS];
+    int used_ops;
+    uint32_t translated[IMEM_SIZE / 32];  // IMEM words covered by a translation
+} FuncCore;
+
+typedef struct {
+    bool enabled;
+    FuncCore *cores;                // NUM_CORES, allocated when enabled
+    uint64_t blocks_translated;
+    uint64_t flushes;               // Translation caches dropped (pool full or IMEM rewritten)
+} FuncEngine;
+
+/* ============================================
+ * PER-PC HOTSPOT PROFILE (--hotspots)
+ * ============================================ */
+
+// Adding a column is one line here: X(enum id, column name, description)
+#define HOTSPOT_COUNTER_LIST(X) \
+    X(HOT_EXEC,         "exec",    "instructions retired")                                \
+    X(HOT_DECODE_STALL, "dstall",  "decode stall cycles waiting for an operand")          \
+    X(HOT_STALL_CAUSED, "dcause",  "decode stall cycles other PCs waited for this result") \
+    X(HOT_MEM_STALL,    "mstall",  "MEM stall cycles (miss in progress)")                 \
+    X(HOT_READ_MISS,    "rmiss",   "read misses")                                         \
+    X(HOT_WRITE_MISS,   "wmiss",   "write misses")                                        \
+    X(HOT_BUS_WAIT,     "buswait", "MEM stall cycles waiting for the bus grant")
+
+#define HOTSPOT_COUNTER_ENUM(id, name, desc) id,
+
+typedef enum {
+    HOTSPOT_COUNTER_LIST(HOTSPOT_COUNTER_ENUM)
+    HOT_NUM
+} HotspotCounter;
+
+#define HOTSPOT_TOP_N 10                // PCs per core in the summary
+
+typedef struct {
+    bool enabled;
+    uint64_t (*counts)[IMEM_SIZE][HOT_NUM];     // [NUM_CORES], allocated when enabled
+} HotspotProfile;
+
+static inline void hotspot_count(HotspotProfile *hp, int core_id, uint16_t pc, HotspotCounter c) {
+    hp->counts[core_id][pc & (IMEM_SIZE - 1)][c]++;
+}
+
+/* ============================================
+ * FALSE-SHARING / PING-PONG DETECTOR (--sharing-report)
+ * ============================================ */
+
+#define SHARING_NUM_BLOCKS (MAIN_MEM_SIZE / CACHE_BLOCK_SIZE)
+#define SHARING_PINGPONG_MIN 4          // Writer changes that make a block "bouncing"
+#define SHARING_REPORT_MAX 50           // Blocks listed in sharing.txt
+
+// Coherence history of one memory block over the whole run
+typedef struct {
+    uint64_t cost;                  // Bus cycles of its coherence transactions
+    uint32_t transactions;          // Coherence transactions (see sharing.c)
+    uint32_t invalidations;         // Valid copies removed by BusRdX snoops
+    uint32_t transfers;             // Stores by a core other than the previous writer
+    uint32_t downgrades;            // Modified -> Shared on a BusRd snoop
+    uint8_t read_mask[NUM_CORES];   // Words each core has loaded
+    uint8_t write_mask[NUM_CORES];  // Words each core has stored
+    uint8_t lost;                   // Cores whose copy was invalidated and not yet refetched
+    uint8_t last_writer;            // Core id + 1 of the latest store, 0 = none
+} SharingBlock;
+
+typedef struct {
+    bool enabled;
+    bool coherent;                  // The transaction on the bus is coherence traffic
+    SharingBlock *blocks;           // [SHARING_NUM_BLOCKS], allocated when enabled
+} SharingTracker;
+
+/* ============================================
+ * TIMELINE EXPORT (--timeline)
+ * ============================================ */
+
+// Tracks of one core (thread ids in the core's process)
+enum {
+    TL_TRACK_IF = 0,                // Stage occupancy: IF, ID, EX, MEM, WB
+    TL_TRACK_STALL = 5,             // Decode stall spans
+    TL_TRACK_MISS,                  // Miss lifetimes (MEM stall on one access)
+    TL_TRACK_BUS_WAIT,              // Bus requested, not yet granted
+    TL_CORE_TRACKS
+};
+
+// Tracks of the bus process
+enum {
+    TL_TRACK_TRANSACTION = 0,       // Grant through last flush word
+    TL_TRACK_PHASE,                 // Arbitration, request, latency, flush
+    TL_BUS_TRACKS
+};
+
+#define TL_NO_SPAN 0xFFFFFFFFu
+
+// A span still being extended: emitted once its key changes
+typedef struct {
+    uint64_t start;
+    uint32_t key;                   // What the span shows, TL_NO_SPAN = none open
+    uint32_t arg;                   // Extra detail for the event (PC, supplier)
+} TimelineSpan;
+
+typedef struct {
+    bool enabled;
+    FILE *fp;
+    bool first;                     // No event written yet (JSON separators)
+    TimelineSpan core[NUM_CORES][TL_CORE_TRACKS];
+    TimelineSpan bus[TL_BUS_TRACKS];
+    uint64_t decode_stall[NUM_CORES];   // Counters at the previous sample
+    uint64_t mem_stall[NUM_CORES];
+    BusState bus_state;                 // Bus state at the previous sample
+    uint64_t grants;
+    uint64_t events;
+} TimelineExport;
+
+/* ============================================
+ * INTERVAL STATISTICS (--interval N)
+ * ============================================ */
+
+// Cumulative counters of one core, in statsN.txt order
+enum {
+    IV_CYCLES = 0, IV_INSTRUCTIONS, IV_READ_HIT, IV_WRITE_HIT, IV_READ_MISS, IV_WRITE_MISS,
+    IV_DECODE_STALL, IV_MEM_STALL, IV_CORE_COUNTERS
+};
+
+// Every counter at the end of an interval; the CSV holds differences
+typedef struct {
+    uint64_t cycle;
+    uint64_t core[NUM_CORES][IV_CORE_COUNTERS];
+    uint64_t bus[BUS_UTIL_NUM];     // Busy cycles by transaction type, in-flight one included
+} IntervalSample;
+
+typedef struct {
+    bool enabled;
+    uint64_t length;                // Cycles per interval
+    uint64_t next;                  // Cycle of the next snapshot
+    IntervalSample *samples;        // samples[0] is the start of the run
+    int count;
+    int capacity;
+} IntervalStats;
+
+/* ============================================
+ * MEMORY-REFERENCE TRACE (--record-mem / --replay-mem)
+ * ============================================ */
+
+typedef enum {
+    MEMREF_LOAD = 'L',
+    MEMREF_STORE = 'S',
+    MEMREF_HALT = 'H'               // End of the core's run
+} MemRefOp;
+
+// One LW/SW as stage_memory first attempted it
+typedef struct {
+    uint64_t gap;                   // Cycles after the core's previous reference performed (from cycle 0)
+    uint32_t addr;
+    uint32_t data;                  // SW data
+    MemRefOp op;
+} MemRef;
+
+typedef struct {
+    MemRef *refs;
+    int count;
+    int capacity;
+    int next;                       // Reference being replayed
+    uint64_t ready;                 // Cycle of its first attempt
+    bool issued;                    // Attempted, waiting for the fill
+    bool reread;                    // A load performed last cycle: stage_writeback's re-read is due
+    uint32_t reread_addr;
+    bool done;
+} MemTraceCore;
+
+typedef struct {
+    FILE *record;                   // --record-mem, streamed during the run
+    uint64_t performed[NUM_CORES];  // Cycle each core's last reference performed
+    MemTraceCore *cores;            // [NUM_CORES] while replaying
+} MemTrace;
+
 /* ============================================
  * SIMULATOR STATE
  * ============================================ */
 
+// Run-time options (parsed from "--option" command line arguments)
+typedef struct {
+    bool miss_classify;       // --miss-classify
+    bool self_profile;        // --self-profile
+    uint64_t starvation_threshold; // --starvation-threshold N (0 = BUS_STARVATION_THRESHOLD)
+    TraceConfig trace;
+    int output_threads;             // --output-threads N (0 = OUTPUT_DEFAULT_THREADS)
+    const char *fingerprint_file;   // --fingerprint FILE
+    uint64_t fingerprint_interval;  // --fingerprint-interval N
+    bool server;                    // --server: serve jobs on stdin/stdout (server.c)
+    const char *server_socket;      // --server-socket PATH: serve jobs on a Unix socket
+    bool cosim;                     // --cosim: check every retirement against the ISA model
+    bool spin_ff;                   // --spin-ff: fast-forward cores spinning on a cached flag
+    bool functional;                // --functional: ISA-level execution, no timing (functional.c)
+    const char *warm_start;         // --warm-start DIR: caches and memory from a saved end state
+    bool hotspots;                  // --hotspots: per-PC stalls and misses, writes hotspots.txt
+    bool sharing_report;            // --sharing-report: false sharing and ping-pong, writes sharing.txt
+    const char *timeline_file;      // --timeline FILE: Chrome trace-event JSON, streamed during the run
+    uint64_t interval;              // --interval N: counter deltas every N cycles, writes intervals.csv
+    const char *record_mem;         // --record-mem FILE: per-core LW/SW trace for --replay-mem
+    const char *replay_mem;         // --replay-mem FILE: drive caches and bus from a recorded trace
+    bool dram;                      // --dram: banked DRAM timing instead of MAIN_MEM_LATENCY, writes dram.txt
+    uint32_t llc_size;              // --llc WORDS: shared LLC behind the bus (0 = none), writes llc*.txt
+    int llc_ways;                   // --llc-ways N
+    int llc_latency;                // --llc-latency N: cycles to the first word on a hit
+    LLCPolicy llc_policy;           // --llc-policy inclusive|non-inclusive|exclusive
+} SimOptions;
+
+// Event callbacks for embedders (simlib.h). Unset hooks cost one pointer test.
+typedef struct {
+    void (*on_retire)(void *user, int core_id, uint16_t pc, uint32_t inst_word, uint64_t cycle);
+    void (*on_bus)(void *user, const BusTransaction *trans, uint64_t cycle);  // Every bus trace record
+    void (*on_miss)(void *user, int core_id, uint16_t pc, uint32_t addr, bool is_write, uint64_t cycle);
+    void *user;
+} SimHooks;
+
+// Fetch breakpoints: one bit per (core, PC)
+typedef struct {
+    uint32_t mask[NUM_CORES][IMEM_SIZE / 32];
+    int count;
+    bool hit;                       // Set by the first breakpoint fetch of a run_until call
+    int hit_core;
+    uint16_t hit_pc;
+} SimBreakpoints;
+
+// Triggered-capture state (only used when a trace trigger is configured)
+typedef struct {
+    bool capturing;
+    uint64_t capture_end;           // Last cycle of the current capture
+    uint64_t triggers;              // Captures started
+} TraceState;
+
+/* ============================================
+ * HOST MEMORY ARENA
+ * ============================================ */
+
+// One zeroed mapping holding the large arrays (trace buffers, main memory),
+// backed by huge pages when the host allows it. Slices are handed out in
+// order and stay put until the arena is released.
+#define ARENA_ALIGN 4096
+
+typedef enum {
+    ARENA_NONE = 0,
+    ARENA_HUGE_PAGES,         // Explicit huge pages (MAP_HUGETLB / MEM_LARGE_PAGES)
+    ARENA_TRANSPARENT_HUGE,   // Regular mapping with MADV_HUGEPAGE
+    ARENA_SMALL_PAGES
+} ArenaKind;
+
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    ArenaKind kind;
+} SimArena;
+
+#define SIM_ARENA_SIZE ((size_t)TRACE_NUM_STREAMS * MAX_TRACE_LINES * TRACE_LINE_SIZE + \
+                        (size_t)MAIN_MEM_SIZE * sizeof(uint32_t) + TRACE_NUM_STREAMS * ARENA_ALIGN + ARENA_ALIGN)
+
+// The cores and the bus come first: everything touched every cycle is packed
+// into a few hundred contiguous cache lines.
 typedef struct {
     Core cores[NUM_CORES];
-    MainMemory main_memory;
     BusArbiter bus;
+    TagDirectory tags;              // TSRAM of every cache
     uint64_t global_cycle;
     bool running;
+    TraceState trace;
+    SimOptions options;
+    SimHooks hooks;
+    SimBreakpoints breakpoints;
+    MainMemory main_memory;
+    TraceFingerprint fingerprint;
+    CosimChecker cosim;
+    SpinForward spin;
+    FuncEngine func;
+    HotspotProfile hotspots;
+    SharingTracker sharing;
+    TimelineExport timeline;
+    IntervalStats intervals;
+    MemTrace memtrace;
+    DramModel dram;
+    SharedLLC llc;
+    MissClassifier miss_class[NUM_CORES];
+    SimArena arena;
 } Simulator;
 
+/* ============================================
+ * HOST SELF-PROFILING
+ * ============================================ */
+
+// Phases are inclusive: cache_snoop and add_bus_trace_entry run inside bus_cycle
+#define PROFILE_PHASE_LIST(X) \
+    X(PROF_BUS_CYCLE,       "bus_cycle")           \
+    X(PROF_SNOOP,           "cache_snoop")         \
+    X(PROF_BUS_TRACE,       "add_bus_trace_entry") \
+    X(PROF_STAGE_WRITEBACK, "stage_writeback")     \
+    X(PROF_STAGE_MEMORY,    "stage_memory")        \
+    X(PROF_STAGE_EXECUTE,   "stage_execute")       \
+    X(PROF_STAGE_DECODE,    "stage_decode")        \
+    X(PROF_STAGE_FETCH,     "stage_fetch")         \
+    X(PROF_CORE_TRACE,      "log_cycle_trace")     \
+    X(PROF_SAVE_TRACES,     "save_trace/bustrace") \
+    X(PROF_SAVE_OUTPUTS,    "save_outputs")
+
+#define PROFILE_PHASE_ENUM(id, name) id,
+
+typedef enum {
+    PROFILE_PHASE_LIST(PROFILE_PHASE_ENUM)
+    PROF_NUM_PHASES
+} ProfilePhase;
+
+#define PROFILE_MAX_THREADS 16
+#define PROFILE_MAX_SAMPLES 256      // Throughput-over-time samples kept
+#define PROFILE_SAMPLE_INTERVAL 4096 // Initial simulated cycles per sample (doubles when full)
+
+extern bool profile_enabled;
+
+#if SIM_PROFILE
+#define PROFILE_BEGIN(phase) uint64_t prof_t0_##phase = profile_enabled ? profile_now() : 0
+#define PROFILE_END(phase) \
+    do { if (profile_enabled) profile_add(phase, profile_now() - prof_t0_##phase); } while (0)
+#else
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+#endif
+
+/* ============================================
+ * OUTPUT WRITERS
+ * ============================================ */
+
+#define OUTBUF_SIZE (1 << 20)       // Per-file write buffer
+#define OUTBUF_ALIGN 4096
+#define OUTPUT_DEFAULT_THREADS 4    // --output-threads N
+#define OUTPUT_MAX_THREADS 16
+
+typedef struct {
+    FILE *fp;
+    char *buf;
+    size_t len;
+    bool ok;                        // false after any failed write
+} OutBuf;
+
 /* ============================================
  * FUNCTION DECLARATIONS
  * ============================================ */
 
 // Initialization
+Simulator* alloc_simulator(void);
+void free_simulator(Simulator *sim);
 void init_simulator(Simulator *sim);
 void init_core(Core *core, int core_id);
 void init_cache(Cache *cache);
+void init_core_tags(TagDirectory *tags, int core_id);
 void init_main_memory(MainMemory *mem);
 void init_bus_arbiter(BusArbiter *bus);
 
+// Host memory arena (arena.c)
+bool arena_init(SimArena *arena, size_t size);
+void* arena_alloc(SimArena *arena, size_t size);
+void arena_reset(SimArena *arena);
+void arena_release(SimArena *arena);
+const char* arena_kind_name(ArenaKind kind);
+
 // Cache operations
-bool cache_read(Cache* cache, uint32_t addr, uint32_t* data, Simulator* sim, int core_id);
-bool cache_write(Cache* cache, uint32_t addr, uint32_t data, Simulator* sim, int core_id);
+// state: this core's state for addr's block, from tag_dir_probe()
+bool cache_read(Cache* cache, uint32_t addr, MESIState state, uint32_t* data, Simulator* sim, int core_id);
+bool cache_write(Cache* cache, uint32_t addr, MESIState state, uint32_t data, Simulator* sim, int core_id);
+bool check_cache_coherence(Simulator *sim);
+void cache_overlay_modified(Simulator *sim, uint32_t *image);
+void cache_flush_all(Simulator *sim);
 
 // Instruction operations
 Instruction decode_instruction(uint32_t inst_word);
@@ -298,25 +1149,31 @@ uint8_t get_dest_register(Instruction inst);
 // Core operations
 void execute_core_cycle(Core *core, Simulator *sim);
 void stage_fetch(Core *core);
-void stage_decode(Core *core);
+void stage_decode(Core *core, Simulator *sim);
 void stage_execute(Core *core);
 void stage_memory(Core *core, Simulator *sim);
+CorePerfCounter mem_stall_cause(Simulator *sim, int core_id);
 void stage_writeback(Core *core, Simulator *sim);
+void log_cycle_trace(Core *core);
+void format_cycle_trace(Core *core, char *buffer);
+void capture_cycle_trace(Core *core, CoreTraceRecord *rec);
+void format_core_trace_record(const CoreTraceRecord *rec, char *buffer);
 
 // Register file operations
 uint32_t read_register(Core *core, uint8_t reg, uint32_t imm_val);
 void write_register(Core *core, uint8_t reg, uint32_t value);
 
 // Cache operations
-bool cache_read(Cache *cache, uint32_t addr, uint32_t *data, Simulator *sim, int core_id);
-bool cache_write(Cache *cache, uint32_t addr, uint32_t data, Simulator *sim, int core_id);
-void cache_snoop(Cache *cache, BusTransaction *trans, int core_id, Simulator *sim);
-void cache_handle_bus_response(Cache *cache, BusTransaction *trans, int core_id, Simulator *sim);
+void cache_snoop(Cache *cache, BusTransaction *trans, MESIState state, int core_id, Simulator *sim);
+void cache_fill_block(Cache *cache, uint32_t block_addr, const uint32_t *data, int words, bool commit,
+                      int core_id, Simulator *sim);
 // Bus operations
 void bus_cycle(Simulator *sim);
-void bus_request(BusArbiter *bus, int core_id, BusCommand cmd, uint32_t addr, uint32_t data);
-void bus_arbitrate(BusArbiter *bus);
+void bus_sync_flush(Simulator *sim);
+void bus_request(BusArbiter *bus, int core_id, BusCommand cmd, uint32_t addr, uint32_t data, uint64_t cycle);
+void bus_arbitrate(BusArbiter *bus, uint64_t cycle);
 void add_bus_trace_entry(BusArbiter *bus, BusTransaction *trans, uint64_t cycle);
+void format_bus_trace(BusTransaction *trans, uint64_t cycle, char *buffer);
 
 // Main memory operations
 void memory_cycle(MainMemory *mem, BusTransaction *bus_trans, Simulator *sim);
@@ -328,17 +1185,143 @@ void memory_write_block(MainMemory *mem, uint32_t block_addr, uint32_t *block_da
 // File I/O
 bool load_imem(const char *filename, uint32_t *imem);
 bool load_memin(const char *filename, MainMemory *mem);
+int parse_imem_text(const char *text, size_t len, uint32_t *imem);
+int parse_memin_text(const char *text, size_t len, MainMemory *mem);
+bool load_dsram(const char *filename, Cache *cache);
+bool load_tsram(const char *filename, TagDirectory *tags, int core_id);
+bool load_warm_start(Simulator *sim, const char *dir);
 bool save_memout(const char *filename, MainMemory *mem);
 bool save_regout(const char *filename, Core *core);
 bool save_trace(const char *filename, Core *core);
 bool save_bustrace(const char *filename, BusArbiter *bus);
 bool save_dsram(const char *filename, Cache *cache);
-bool save_tsram(const char *filename, Cache *cache);
+bool save_tsram(const char *filename, const TagDirectory *tags, int core_id);
 bool save_stats(const char *filename, Core *core);
 bool save_assembly(const char *filename, uint32_t *imem, int size);
+void format_assembly_line(uint32_t inst_word, int pc, char *buffer);   // buffer: 128 bytes
+bool make_sibling_path(const char *sibling, const char *name, char *path, size_t size);
+
+// Output writers
+char* fmt_hex(char *dst, uint32_t value, int digits);
+char* fmt_u64(char *dst, uint64_t value);
+bool outbuf_open(OutBuf *ob, FILE *fp);
+void outbuf_flush(OutBuf *ob);
+void outbuf_write(OutBuf *ob, const char *s, size_t n);
+void outbuf_hex_line(OutBuf *ob, uint32_t value);
+void outbuf_stat_line(OutBuf *ob, const char *name, uint64_t value);
+bool outbuf_close(OutBuf *ob);
+bool save_outputs(const char *files[], Simulator *sim, int threads);
+
+// Performance counters
+const char* core_perf_counter_name(int id);
+const char* bus_perf_counter_name(int id);
+bool save_perf_stats(const char *filename, Core *core);
+bool save_bus_perf_stats(const char *filename, BusArbiter *bus);
+bool save_perf_json(const char *filename, Simulator *sim);
+bool save_bus_queue_report(const char *filename, BusArbiter *bus, uint64_t total_cycles);
+
+// Miss classification
+const char* miss_class_name(int cls);
+void miss_classify_access(Simulator *sim, int core_id, uint16_t pc, uint32_t addr,
+                          bool is_write, bool hit, bool first_attempt);
+void miss_classify_invalidation(Simulator *sim, int core_id, uint32_t addr);
+bool save_miss_classification(const char *filename, Simulator *sim);
+
+// Co-simulation
+bool cosim_init(CosimChecker *cs);
+void cosim_start(Simulator *sim);
+void cosim_retire(Simulator *sim, Core *core, const PipelineReg *wb);
+void cosim_free(CosimChecker *cs);
+
+// Spin-loop fast-forward
+bool spin_init(SpinForward *spin);
+bool spin_replay_cycle(Simulator *sim, Core *core);
+void spin_capture(Simulator *sim, Core *core);
+void spin_end_cycle(Simulator *sim, Core *core);
+void spin_snoop(Simulator *sim, int core_id, uint32_t addr, bool invalidate);
+void spin_sync(Simulator *sim);
+void spin_free(SpinForward *spin);
+
+// Functional execution
+bool func_init(FuncEngine *fe);
+bool func_run(Simulator *sim, uint64_t limit);
+void func_invalidate(FuncEngine *fe, int core_id, uint16_t pc, int count);
+void func_free(FuncEngine *fe);
+
+// Per-PC hotspot profile
+bool hotspot_init(HotspotProfile *hp);
+void hotspot_decode_stall(Simulator *sim, Core *core, int reg);
+bool save_hotspots(const char *filename, Simulator *sim);
+void hotspot_free(HotspotProfile *hp);
+
+// False-sharing / ping-pong detector
+bool sharing_init(SharingTracker *st);
+void sharing_snoop(Simulator *sim, int core_id, uint32_t addr, BusCommand cmd, MESIState state);
+void sharing_fill(Simulator *sim, int core_id, uint32_t block_addr);
+void sharing_access(Simulator *sim, int core_id, uint32_t addr, bool is_write);
+bool save_sharing_report(const char *filename, Simulator *sim);
+void sharing_free(SharingTracker *st);
+
+// Timeline export
+bool timeline_init(TimelineExport *tl, const char *filename);
+void timeline_cycle(Simulator *sim);
+void timeline_close(Simulator *sim);
+
+// Interval statistics
+bool interval_init(IntervalStats *iv, uint64_t length);
+void interval_snapshot(Simulator *sim);
+bool save_interval_stats(const char *filename, Simulator *sim);
+void interval_free(IntervalStats *iv);
+
+// Memory-reference trace
+bool memtrace_record_open(Simulator *sim, const char *filename);
+void memtrace_record(Simulator *sim, int core_id, bool is_write, uint32_t addr, uint32_t data,
+                     bool hit, bool first_attempt);
+bool memtrace_replay(Simulator *sim, const char *filename);
+void memtrace_close(Simulator *sim);
+
+// Banked DRAM timing
+void dram_init(DramModel *dm);
+uint32_t dram_read(DramModel *dm, uint32_t addr, uint64_t now);
+void dram_write(DramModel *dm, uint32_t addr, uint64_t now);
+bool save_dram_stats(const char *filename, Simulator *sim);
+
+// Shared last-level cache
+bool llc_init(SharedLLC *llc, const SimOptions *options);
+void llc_free(SharedLLC *llc);
+int llc_read(Simulator *sim, uint32_t addr);
+bool llc_write(Simulator *sim, uint32_t block_addr);
+void llc_l1_victim(Simulator *sim, int core_id, uint32_t block_addr);
+bool save_llc_stats(const char *filename, SharedLLC *llc);
+bool save_llc_dsram(const char *filename, SharedLLC *llc);
+bool save_llc_tsram(const char *filename, SharedLLC *llc);
+
+// Trace control
+char* trace_claim_line(Simulator *sim, int stream, char (*lines)[TRACE_LINE_SIZE], int *count, TraceRing *ring);
+void trace_cycle_begin(Simulator *sim);
+bool trace_cycle_in_windows(const TraceConfig *cfg, uint64_t cycle);
+void trace_check_pc(Simulator *sim, int core_id, uint16_t pc);
+void trace_check_addr(Simulator *sim, uint32_t addr);
+
+// Trace fingerprint
+void fingerprint_init(TraceFingerprint *fp, uint64_t interval);
+void fingerprint_core(TraceFingerprint *fp, int core_id, const CoreTraceRecord *rec);
+void fingerprint_bus(TraceFingerprint *fp, uint64_t cycle, const BusTransaction *trans);
+void fingerprint_cycle(TraceFingerprint *fp, uint64_t cycle);
+bool save_fingerprint(const char *filename, TraceFingerprint *fp, uint64_t total_cycles);
+void fingerprint_free(TraceFingerprint *fp);
+
+// Self-profiling
+uint64_t profile_now(void);
+void profile_add(ProfilePhase phase, uint64_t ticks);
+void profile_start(void);
+void profile_sample(uint64_t sim_cycle);
+void profile_report(FILE *fp);
 
 // Simulation control
 void run_simulator(Simulator *sim);
+void simulate_cycle(Simulator *sim);
+bool simulation_done(Simulator *sim);
 bool all_cores_halted(Simulator *sim);
 bool all_pipelines_empty(Simulator *sim);
 
@@ -0,0 +1,341 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simlib.h"
+
+// ====================================================================================
+// LIFECYCLE
+// ====================================================================================
+
+void simlib_default_options(SimOptions *options) {
+    memset(options, 0, sizeof(SimOptions));
+    options->trace.pre_cycles = TRACE_DEFAULT_PRE;
+    options->trace.post_cycles = TRACE_DEFAULT_POST;
+    options->llc_ways = LLC_DEFAULT_WAYS;
+    options->llc_latency = LLC_DEFAULT_LATENCY;
+    options->llc_policy = LLC_INCLUSIVE;
+}
+
+// The optional features sim->options asks for; false if one fails (reported on stderr)
+static bool init_features(Simulator *sim) {
+    const SimOptions *options = &sim->options;
+    if (options->starvation_threshold) sim->bus.starvation_threshold = options->starvation_threshold;
+    if (options->fingerprint_file) fingerprint_init(&sim->fingerprint, options->fingerprint_interval);
+    if (options->dram) dram_init(&sim->dram);
+    return !((options->cosim && !cosim_init(&sim->cosim)) || (options->spin_ff && !spin_init(&sim->spin)) ||
+             (options->hotspots && !hotspot_init(&sim->hotspots)) ||
+             (options->sharing_report && !sharing_init(&sim->sharing)) ||
+             (options->timeline_file && !timeline_init(&sim->timeline, options->timeline_file)) ||
+             (options->interval && !interval_init(&sim->intervals, options->interval)) ||
+             (options->record_mem && !memtrace_record_open(sim, options->record_mem)) ||
+             (options->llc_size && !llc_init(&sim->llc, options)));
+}
+
+Simulator* simlib_create(const SimOptions *options) {
+    // Every failure below reports its cause on stderr
+    Simulator *sim = alloc_simulator();
+    if (!sim) {
+        fprintf(stderr, "Error: Out of memory for the simulator\n");
+        return NULL;
+    }
+
+    init_simulator(sim);
+    if (options) sim->options = *options;
+    else simlib_default_options(&sim->options);
+    if (!init_features(sim)) {
+        simlib_destroy(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+bool simlib_reset(Simulator *sim) {
+    SimOptions options = sim->options;
+    SimHooks hooks = sim->hooks;
+    SimBreakpoints breakpoints = sim->breakpoints;
+    fingerprint_free(&sim->fingerprint);
+    cosim_free(&sim->cosim);
+    spin_free(&sim->spin);
+    func_free(&sim->func);
+    hotspot_free(&sim->hotspots);
+    sharing_free(&sim->sharing);
+    timeline_close(sim);
+    interval_free(&sim->intervals);
+    memtrace_close(sim);
+    llc_free(&sim->llc);
+
+    init_simulator(sim);
+
+    sim->options = options;
+    sim->hooks = hooks;
+    sim->breakpoints = breakpoints;
+    sim->breakpoints.hit = false;
+    return init_features(sim);      // Restarts the --timeline and --record-mem files
+}
+
+void simlib_destroy(Simulator *sim) {
+    if (!sim) return;
+    fingerprint_free(&sim->fingerprint);
+    cosim_free(&sim->cosim);
+    spin_free(&sim->spin);
+    func_free(&sim->func);
+    hotspot_free(&sim->hotspots);
+    sharing_free(&sim->sharing);
+    timeline_close(sim);
+    interval_free(&sim->intervals);
+    memtrace_close(sim);
+    llc_free(&sim->llc);
+    free_simulator(sim);
+}
+
+// ====================================================================================
+// LOADING
+// ====================================================================================
+
+// Words past count are zero; false if the program does not fit
+bool simlib_load_program(Simulator *sim, int core_id, const uint32_t *words, size_t count) {
+    if (core_id < 0 || core_id >= NUM_CORES || count > IMEM_SIZE) return false;
+    uint32_t *imem = sim->cores[core_id].imem;
+    memcpy(imem, words, count * sizeof(uint32_t));
+    memset(imem + count, 0, (IMEM_SIZE - count) * sizeof(uint32_t));
+    func_invalidate(&sim->func, core_id, 0, IMEM_SIZE);
+    return true;
+}
+
+// Same format as imemN.txt
+bool simlib_load_program_text(Simulator *sim, int core_id, const char *text, size_t len) {
+    if (core_id < 0 || core_id >= NUM_CORES) return false;
+    parse_imem_text(text, len, sim->cores[core_id].imem);
+    func_invalidate(&sim->func, core_id, 0, IMEM_SIZE);
+    return true;
+}
+
+bool simlib_load_memory(Simulator *sim, uint32_t addr, const uint32_t *words, size_t count) {
+    if (addr > MAIN_MEM_SIZE || count > MAIN_MEM_SIZE - addr) return false;
+    memcpy(&sim->main_memory.data[addr], words, count * sizeof(uint32_t));
+    memory_mark_dirty(&sim->main_memory, addr, (uint32_t)count);
+    return true;
+}
+
+// Same format as memin.txt
+bool simlib_load_memory_text(Simulator *sim, const char *text, size_t len) {
+    parse_memin_text(text, len, &sim->main_memory);
+    return true;
+}
+
+// An earlier run's saved memout/dsram/tsram; false on a missing file or an
+// inconsistent image (reported on stderr)
+bool simlib_warm_start(Simulator *sim, const char *dir) {
+    return load_warm_start(sim, dir);
+}
+
+// ====================================================================================
+// EXECUTION
+// ====================================================================================
+
+bool simlib_done(Simulator *sim) {
+    return simulation_done(sim);
+}
+
+SimStopReason simlib_run_until(Simulator *sim, SimPredicate predicate, void *user, uint64_t max_cycles) {
+    sim->breakpoints.hit = false;
+    for (uint64_t i = 0; i < max_cycles; i++) {
+        if (simulation_done(sim)) break;
+        simulate_cycle(sim);
+        if (sim->breakpoints.hit) return SIM_STOP_BREAKPOINT;
+        if (predicate) {
+            spin_sync(sim);     // The predicate may read a parked core's registers
+            if (predicate(sim, user)) return SIM_STOP_PREDICATE;
+        }
+    }
+    // Counters and state of parked spin loops are brought up to date here
+    spin_sync(sim);
+    if (sim->cosim.failed) return SIM_STOP_MISMATCH;
+    return simulation_done(sim) ? SIM_STOP_DONE : SIM_STOP_LIMIT;
+}
+
+SimStopReason simlib_step(Simulator *sim, uint64_t cycles) {
+    SimStopReason reason = simlib_run_until(sim, NULL, NULL, cycles);
+    return reason == SIM_STOP_LIMIT ? SIM_STOP_CYCLES : reason;
+}
+
+void simlib_run(Simulator *sim) {
+    run_simulator(sim);
+}
+
+bool simlib_run_memory_trace(Simulator *sim, const char *filename) {
+    return memtrace_replay(sim, filename);
+}
+
+SimStopReason simlib_run_functional(Simulator *sim, uint64_t max_instructions) {
+    if (!sim->func.enabled && !func_init(&sim->func)) return SIM_STOP_LIMIT;
+    return func_run(sim, max_instructions) ? SIM_STOP_DONE : SIM_STOP_LIMIT;
+}
+
+// ====================================================================================
+// INSPECTION
+// Reads of memory and cache data first apply the words of a fill that is still
+// on the bus (bus_sync_flush), so they match the word-by-word bus model.
+// ====================================================================================
+
+uint64_t simlib_cycle(const Simulator *sim) {
+    return sim->global_cycle;
+}
+
+uint32_t simlib_register(const Simulator *sim, int core_id, int reg) {
+    if (core_id < 0 || core_id >= NUM_CORES || reg < 0 || reg >= NUM_REGISTERS) return 0;
+    return sim->cores[core_id].registers[reg];
+}
+
+uint16_t simlib_pc(const Simulator *sim, int core_id) {
+    if (core_id < 0 || core_id >= NUM_CORES) return 0;
+    return sim->cores[core_id].pc;
+}
+
+bool simlib_halted(const Simulator *sim, int core_id) {
+    if (core_id < 0 || core_id >= NUM_CORES) return true;
+    return sim->cores[core_id].halted;
+}
+
+uint32_t simlib_read_memory(Simulator *sim, uint32_t addr) {
+    bus_sync_flush(sim);
+    return sim->main_memory.data[addr & (MAIN_MEM_SIZE - 1)];
+}
+
+uint32_t simlib_read_coherent(Simulator *sim, uint32_t addr) {
+    addr &= MAIN_MEM_SIZE - 1;
+    bus_sync_flush(sim);
+    uint64_t holders = tag_dir_probe(&sim->tags, addr);
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (tag_lane_state(holders, i) == MESI_MODIFIED) {
+            return sim->cores[i].cache.dsram[((addr >> 3) & 0x3F) * CACHE_BLOCK_SIZE + (addr & 0x7)];
+        }
+    }
+    return sim->main_memory.data[addr];
+}
+
+bool simlib_cache_line(Simulator *sim, int core_id, int index, SimCacheLine *line) {
+    if (core_id < 0 || core_id >= NUM_CORES || index < 0 || index >= NUM_CACHE_BLOCKS) return false;
+    bus_sync_flush(sim);
+    TSRAMEntry entry = tag_dir_get(&sim->tags, index, core_id);
+    line->tag = tsram_tag(entry);
+    line->state = tsram_state(entry);
+    line->addr = ((uint32_t)line->tag << 9) | ((uint32_t)index << 3);
+    memcpy(line->data, &sim->cores[core_id].cache.dsram[index * CACHE_BLOCK_SIZE], sizeof(line->data));
+    return true;
+}
+
+// ====================================================================================
+// BREAKPOINTS AND CALLBACKS
+// ====================================================================================
+
+bool simlib_add_breakpoint(Simulator *sim, int core_id, uint16_t pc) {
+    if (core_id < -1 || core_id >= NUM_CORES || pc >= IMEM_SIZE) return false;
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (core_id == -1 || core_id == i) sim->breakpoints.mask[i][pc >> 5] |= 1u << (pc & 31);
+    }
+    sim->breakpoints.count++;
+    return true;
+}
+
+void simlib_clear_breakpoints(Simulator *sim) {
+    memset(&sim->breakpoints, 0, sizeof(SimBreakpoints));
+}
+
+void simlib_set_hooks(Simulator *sim, const SimHooks *hooks) {
+    if (hooks) sim->hooks = *hooks;
+    else memset(&sim->hooks, 0, sizeof(SimHooks));
+}
+
+// ====================================================================================
+// OUTPUT FILES
+// ====================================================================================
+
+bool simlib_save_outputs(Simulator *sim, const char *files[]) {
+    PROFILE_BEGIN(PROF_SAVE_OUTPUTS);
+    bus_sync_flush(sim);
+
+    // The 22 required outputs, written concurrently
+    if (!save_outputs(files, sim, sim->options.output_threads ? sim->options.output_threads
+                                                              : OUTPUT_DEFAULT_THREADS)) {
+        PROFILE_END(PROF_SAVE_OUTPUTS);
+        return false;
+    }
+
+    // Bus queueing / arbitration report next to bustrace.txt
+    char queue_path[1024];
+    if (make_sibling_path(files[14], "busqueue.txt", queue_path, sizeof(queue_path))) {
+        save_bus_queue_report(queue_path, &sim->bus, sim->global_cycle);
+    }
+
+#if PERF_COUNTERS
+    // Extended counters: stats-style perfN.txt / perfbus.txt plus perf.json, next to stats files
+    char perf_path[1024];
+    for (int i = 0; i < NUM_CORES; i++) {
+        char perf_name[32];
+        sprintf(perf_name, "perf%d.txt", i);
+        if (make_sibling_path(files[23 + i], perf_name, perf_path, sizeof(perf_path))) {
+            save_perf_stats(perf_path, &sim->cores[i]);
+        }
+    }
+    if (make_sibling_path(files[23], "perfbus.txt", perf_path, sizeof(perf_path))) {
+        save_bus_perf_stats(perf_path, &sim->bus);
+    }
+    if (make_sibling_path(files[23], "perf.json", perf_path, sizeof(perf_path))) {
+        save_perf_json(perf_path, sim);
+    }
+#endif
+
+    if (sim->fingerprint.enabled) {
+        save_fingerprint(sim->options.fingerprint_file, &sim->fingerprint, sim->global_cycle);
+    }
+
+    if (sim->options.miss_classify) {
+        char miss_path[1024];
+        if (make_sibling_path(files[23], "missclass.csv", miss_path, sizeof(miss_path))) {
+            save_miss_classification(miss_path, sim);
+        }
+    }
+
+    if (sim->hotspots.enabled) {
+        char hot_path[1024];
+        if (make_sibling_path(files[23], "hotspots.txt", hot_path, sizeof(hot_path))) {
+            save_hotspots(hot_path, sim);
+        }
+    }
+
+    if (sim->sharing.enabled) {
+        char sharing_path[1024];
+        if (make_sibling_path(files[23], "sharing.txt", sharing_path, sizeof(sharing_path))) {
+            save_sharing_report(sharing_path, sim);
+        }
+    }
+
+    if (sim->intervals.enabled) {
+        char interval_path[1024];
+        if (make_sibling_path(files[23], "intervals.csv", interval_path, sizeof(interval_path))) {
+            save_interval_stats(interval_path, sim);
+        }
+    }
+
+    if (sim->dram.enabled) {
+        char dram_path[1024];
+        if (make_sibling_path(files[23], "dram.txt", dram_path, sizeof(dram_path))) {
+            save_dram_stats(dram_path, sim);
+        }
+    }
+
+    // LLC counterparts of statsN / dsramN / tsramN
+    if (sim->llc.enabled) {
+        char llc_path[1024];
+        if (make_sibling_path(files[23], "llcstats.txt", llc_path, sizeof(llc_path))) save_llc_stats(llc_path, &sim->llc);
+        if (make_sibling_path(files[15], "llcdsram.txt", llc_path, sizeof(llc_path))) save_llc_dsram(llc_path, &sim->llc);
+        if (make_sibling_path(files[19], "llctsram.txt", llc_path, sizeof(llc_path))) save_llc_tsram(llc_path, &sim->llc);
+    }
+
+    PROFILE_END(PROF_SAVE_OUTPUTS);
+    return true;
+}
@@ -0,0 +1,104 @@
+#ifndef SIMLIB_H
+#define SIMLIB_H
+
+#include "sim.h"
+
+/* ============================================
+ * EMBEDDABLE SIMULATOR API
+ * ============================================
+ *
+ * Drives the simulator in-process, without files: build the library
+ * (make lib -> build/linux/libca2026sim.a) and include this header.
+ *
+ *   Simulator *sim = simlib_create(NULL);
+ *   simlib_load_program(sim, 0, words, count);
+ *   simlib_run_until(sim, NULL, NULL, 100000);
+ *   uint32_t r2 = simlib_register(sim, 0, 2);
+ *   if (!simlib_reset(sim)) ...     // next scenario, same buffers
+ *   ...
+ *   simlib_destroy(sim);
+ *
+ * The CLI (main.c) is a wrapper over these calls. Simulator is not opaque;
+ * statistics and counters can be read from it directly.
+ */
+
+typedef enum {
+    SIM_STOP_CYCLES = 0,   // Ran the requested number of cycles
+    SIM_STOP_DONE,         // All cores halted and all pipelines drained
+    SIM_STOP_BREAKPOINT,   // A breakpoint PC was fetched (see sim->breakpoints)
+    SIM_STOP_PREDICATE,    // run_until's predicate returned true
+    SIM_STOP_LIMIT,        // run_until reached max_cycles
+    SIM_STOP_MISMATCH      // --cosim found a retirement the ISA model disagrees with
+} SimStopReason;
+
+// Checked after every cycle; return true to stop
+typedef bool (*SimPredicate)(Simulator *sim, void *user);
+
+// One cache line as the TSRAM/DSRAM hold it
+typedef struct {
+    uint16_t tag;
+    MESIState state;
+    uint32_t addr;                      // Block base address
+    uint32_t data[CACHE_BLOCK_SIZE];
+} SimCacheLine;
+
+// Lifecycle. options may be NULL (defaults: full traces, no extras).
+void simlib_default_options(SimOptions *options);
+Simulator* simlib_create(const SimOptions *options);
+// Power-on state; keeps options, hooks and breakpoints. False if a feature the
+// options enable could not be set up again (reported on stderr, e.g. the
+// --timeline file can no longer be opened): do not run before a successful reset.
+bool simlib_reset(Simulator *sim);
+void simlib_destroy(Simulator *sim);
+
+// Loading, before the first step (memory writes bypass the caches)
+bool simlib_load_program(Simulator *sim, int core_id, const uint32_t *words, size_t count);
+bool simlib_load_program_text(Simulator *sim, int core_id, const char *text, size_t len);
+bool simlib_load_memory(Simulator *sim, uint32_t addr, const uint32_t *words, size_t count);
+bool simlib_load_memory_text(Simulator *sim, const char *text, size_t len);
+bool simlib_warm_start(Simulator *sim, const char *dir);    // DIR/memout, dsramN, tsramN of a saved run
+
+// Execution
+SimStopReason simlib_step(Simulator *sim, uint64_t cycles);
+SimStopReason simlib_run_until(Simulator *sim, SimPredicate predicate, void *user, uint64_t max_cycles);
+void simlib_run(Simulator *sim);            // To completion, with the CLI's cycle cap
+bool simlib_done(Simulator *sim);
+
+// ISA-level run without timing (functional.c): all cores until they halt or
+// have retired max_instructions each (SIM_STOP_DONE / SIM_STOP_LIMIT). Loads
+// and stores go straight to main memory, so run it from power-on state. Cores
+// are left with empty pipelines at an instruction boundary, so a timing run
+// can continue from there with cold caches.
+SimStopReason simlib_run_functional(Simulator *sim, uint64_t max_instructions);
+
+// Memory-system-only run (memtrace.c): replays a --record-mem trace through
+// the caches and bus, no pipelines. Load the same memory image (and warm
+// start) as the recorded run first. False if the trace cannot be read.
+bool simlib_run_memory_trace(Simulator *sim, const char *filename);
+
+// Inspection
+uint64_t simlib_cycle(const Simulator *sim);
+uint32_t simlib_register(const Simulator *sim, int core_id, int reg);
+uint16_t simlib_pc(const Simulator *sim, int core_id);
+bool simlib_halted(const Simulator *sim, int core_id);
+uint32_t simlib_read_memory(Simulator *sim, uint32_t addr);     // Main memory only
+uint32_t simlib_read_coherent(Simulator *sim, uint32_t addr);   // What a load would see (Modified copies win)
+bool simlib_cache_line(Simulator *sim, int core_id, int index, SimCacheLine *line);
+
+// Breakpoints on fetch. core_id -1 = every core.
+bool simlib_add_breakpoint(Simulator *sim, int core_id, uint16_t pc);
+void simlib_clear_breakpoints(Simulator *sim);
+
+// Callbacks (see SimHooks); pass NULL to remove them all
+void simlib_set_hooks(Simulator *sim, const SimHooks *hooks);
+
+// The CLI's output files: files[] uses the command-line layout (outputs at
+// 5..26); the extra reports (busqueue, perf, missclass, hotspots, sharing,
+// intervals, fingerprint) are written next to them as the options request.
+bool simlib_save_outputs(Simulator *sim, const char *files[]);
+
+// Job server (server.c, --server / --server-socket): serves the line protocol
+// documented there on stdin/stdout, or on a Unix socket when socket_path is set
+int run_server(const SimOptions *options, const char *socket_path);
+
+#endif // SIMLIB_H
@@ -0,0 +1,259 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// SPIN-LOOP FAST-FORWARD (--spin-ff)
+// A core polling a flag that hits in its cache repeats the same few cycles
+// until another core writes the flag. Detection is cheap while searching: the
+// core's per-cycle state (everything in Core before the cache) is compared
+// with an anchor snapshot only when the PC and registers match it. Once the
+// state returns to the anchor, with no store, miss or bus request on the way,
+// one more period is recorded (trace records, counter increments, states and
+// the blocks it loads) and checked to end at the anchor again. Then the core
+// is parked.
+//
+// A parked core is not simulated. Each cycle only writes its pre-formatted
+// trace line (or fingerprint record) with the current cycle number. Counters
+// and state are settled arithmetically from the period when they are needed:
+// - on wake-up;
+// - at spin_sync(), when a run stops.
+// Only a BusRdX snoop invalidating a block the loop loads can change the loop.
+// That wakes the core (spin_snoop) before its next cycle. Snoops also count
+// events in the core's perf counters, so a snoop hit restarts a recording and
+// settling adds the loop's increments instead of overwriting the counters. Options that
+// observe individual events are not replayed, so cores are not parked while
+// they are on: hooks, breakpoints, triggers, --cosim, --miss-classify,
+// --hotspots, --timeline and --record-mem.
+// ====================================================================================
+
+bool spin_init(SpinForward *spin) {
+    memset(spin, 0, sizeof(SpinForward));
+    spin->cores = (SpinCore *)calloc(NUM_CORES, sizeof(SpinCore));
+    if (!spin->cores) {
+        fprintf(stderr, "Error: Out of memory for spin-loop detection\n");
+        return false;
+    }
+    spin->enabled = true;
+    return true;
+}
+
+void spin_free(SpinForward *spin) {
+    free(spin->cores);
+    memset(spin, 0, sizeof(SpinForward));
+}
+
+static bool spin_allowed(const Simulator *sim) {
+    const TraceConfig *trace = &sim->options.trace;
+    return !sim->hooks.on_retire && !sim->hooks.on_miss && !sim->breakpoints.count &&
+           !sim->cosim.enabled && !sim->options.miss_classify && !sim->hotspots.enabled &&
+           !sim->timeline.enabled && !sim->memtrace.record && !trace->trigger_pc_enabled && !trace->trigger_addr_enabled;
+}
+
+static void read_counters(const Core *core, uint64_t *c) {
+    c[0] = core->cycles;
+    c[1] = core->instructions;
+    c[2] = core->read_hit;
+    c[3] = core->write_hit;
+    c[4] = core->read_miss;
+    c[5] = core->write_miss;
+    c[6] = core->decode_stall;
+    c[7] = core->mem_stall;
+#if PERF_COUNTERS
+    memcpy(&c[8], core->perf, sizeof(core->perf));
+#endif
+}
+
+static void write_counters(Core *core, const uint64_t *c) {
+    core->cycles = c[0];
+    core->instructions = c[1];
+    core->read_hit = c[2];
+    core->write_hit = c[3];
+    core->read_miss = c[4];
+    core->write_miss = c[5];
+    core->decode_stall = c[6];
+    core->mem_stall = c[7];
+#if PERF_COUNTERS
+    memcpy(core->perf, &c[8], sizeof(core->perf));
+#endif
+}
+
+// Start searching from the current state
+static void spin_anchor(SpinCore *sc, const Core *core) {
+    memcpy(sc->state[0], core, SPIN_STATE_BYTES);
+    sc->mode = SPIN_SEARCH;
+    sc->length = 0;
+}
+
+static void spin_park(Simulator *sim, SpinCore *sc) {
+    memset(sc->prefix[0], 0, sizeof(sc->prefix[0]));
+    for (int k = 0; k < sc->period; k++) {
+        for (int i = 0; i < SPIN_NUM_COUNTERS; i++) sc->prefix[k + 1][i] = sc->prefix[k][i] + sc->delta[k][i];
+
+        // "0 <stages> <registers>": keep everything after the cycle number
+        char line[TRACE_LINE_SIZE];
+        CoreTraceRecord rec = sc->rec[k];
+        rec.cycle = 0;
+        format_core_trace_record(&rec, line);
+        sc->text_len[k] = (int)strlen(line + 1) + 1;
+        memcpy(sc->text[k], line + 1, (size_t)sc->text_len[k]);
+    }
+    memcpy(sc->base, sc->last, sizeof(sc->base));
+    memcpy(sc->applied, sc->last, sizeof(sc->applied));
+    sc->mode = SPIN_PARKED;
+    sc->phase = 0;
+    sc->elapsed = 0;
+    sim->spin.parks++;
+}
+
+// Bring a parked core's counters and state up to the current cycle
+static void spin_settle(SpinCore *sc, Core *core) {
+    uint64_t c[SPIN_NUM_COUNTERS];
+    uint64_t full = sc->elapsed / (uint64_t)sc->period;
+    read_counters(core, c);
+    for (int i = 0; i < SPIN_NUM_COUNTERS; i++) {
+        uint64_t now = sc->base[i] + full * sc->prefix[sc->period][i] + sc->prefix[sc->phase][i];
+        c[i] += now - sc->applied[i];
+        sc->applied[i] = now;
+    }
+    write_counters(core, c);
+    memcpy(core, sc->state[sc->phase], SPIN_STATE_BYTES);
+}
+
+static void spin_wake(SpinCore *sc, Core *core) {
+    spin_settle(sc, core);
+    sc->mode = SPIN_IDLE;
+}
+
+// Parked core: replay one cycle. False if the core must be simulated.
+bool spin_replay_cycle(Simulator *sim, Core *core) {
+    SpinCore *sc = &sim->spin.cores[core->core_id];
+    if (sc->mode != SPIN_PARKED) return false;
+    if (!spin_allowed(sim)) {
+        spin_wake(sc, core);
+        return false;
+    }
+
+    uint64_t cycle = sc->base[0] + sc->elapsed;
+    PROFILE_BEGIN(PROF_CORE_TRACE);
+    if (sim->fingerprint.enabled) {
+        CoreTraceRecord rec = sc->rec[sc->phase];
+        rec.cycle = cycle;
+        fingerprint_core(&sim->fingerprint, core->core_id, &rec);
+    } else {
+        char *line = trace_claim_line(sim, core->core_id, core->trace_lines, &core->trace_count, &core->trace_ring);
+        if (line) memcpy(fmt_u64(line, cycle), sc->text[sc->phase], (size_t)sc->text_len[sc->phase]);
+    }
+    PROFILE_END(PROF_CORE_TRACE);
+
+    sc->elapsed++;
+    if (++sc->phase == sc->period) sc->phase = 0;
+    sim->spin.replayed++;
+    return true;
+}
+
+// Called at the trace point of a simulated cycle
+void spin_capture(Simulator *sim, Core *core) {
+    SpinCore *sc = &sim->spin.cores[core->core_id];
+    if (sc->mode == SPIN_RECORD) capture_cycle_trace(core, &sc->rec[sc->length]);
+}
+
+static bool same_state(const Core *core, const uint8_t *state) {
+    const Core *anchor = (const Core *)state;
+    return core->pc == anchor->pc &&
+           memcmp(core->registers, anchor->registers, sizeof(core->registers)) == 0 &&
+           memcmp(core, state, SPIN_STATE_BYTES) == 0;
+}
+
+// Called after a simulated cycle: search, record, park
+void spin_end_cycle(Simulator *sim, Core *core) {
+    SpinCore *sc = &sim->spin.cores[core->core_id];
+    PipelineReg *mem = &core->pipeline.mem;
+    int id = core->core_id;
+
+    bool ok = sc->mode != SPIN_IDLE && spin_allowed(sim) && !core->halted &&
+              !sim->bus.pending[id] && sim->bus.owner != id;
+    if (ok && mem->valid && (mem->inst.opcode == OP_SW || (mem->inst.opcode == OP_LW && mem->internal_stall))) {
+        ok = false;
+    }
+    if (!ok) {
+        if (!core->halted) spin_anchor(sc, core);
+        return;
+    }
+
+    if (sc->mode == SPIN_SEARCH) {
+        sc->length++;
+        if (same_state(core, sc->state[0])) {
+            sc->mode = SPIN_RECORD;
+            sc->period = sc->length;
+            sc->length = 0;
+            sc->num_blocks = 0;
+            read_counters(core, sc->last);
+        } else if (sc->length == SPIN_MAX_PERIOD) {
+            spin_anchor(sc, core);
+        }
+        return;
+    }
+
+    // SPIN_RECORD: one more period, which must load few blocks and end at the anchor
+    if (mem->valid && mem->inst.opcode == OP_LW) {
+        uint32_t block = mem->alu_result & (MAIN_MEM_SIZE - 1) & ~0x7u;
+        int i = 0;
+        while (i < sc->num_blocks && sc->blocks[i] != block) i++;
+        if (i == sc->num_blocks) {
+            if (i == SPIN_MAX_BLOCKS) {
+                spin_anchor(sc, core);
+                return;
+            }
+            sc->blocks[sc->num_blocks++] = block;
+        }
+    }
+    uint64_t now[SPIN_NUM_COUNTERS];
+    read_counters(core, now);
+    for (int i = 0; i < SPIN_NUM_COUNTERS; i++) {
+        uint64_t d = now[i] - sc->last[i];
+        if (d > 255) {
+            spin_anchor(sc, core);
+            return;
+        }
+        sc->delta[sc->length][i] = (uint8_t)d;
+        sc->last[i] = now[i];
+    }
+    sc->length++;
+    if (sc->length < sc->period) {
+        memcpy(sc->state[sc->length], core, SPIN_STATE_BYTES);
+    } else if (same_state(core, sc->state[0])) {
+        spin_park(sim, sc);
+    } else {
+        spin_anchor(sc, core);
+    }
+}
+
+// A snoop hit core_id's copy of addr's block (invalidate: BusRdX)
+void spin_snoop(Simulator *sim, int core_id, uint32_t addr, bool invalidate) {
+    SpinCore *sc = &sim->spin.cores[core_id];
+    if (sc->mode == SPIN_RECORD) {
+        sc->mode = SPIN_IDLE;       // Its counter increments would be recorded as the loop's
+        return;
+    }
+    if (sc->mode != SPIN_PARKED || !invalidate) return;
+    uint32_t block = addr & (MAIN_MEM_SIZE - 1) & ~0x7u;
+    for (int i = 0; i < sc->num_blocks; i++) {
+        if (sc->blocks[i] == block) {
+            spin_wake(sc, &sim->cores[core_id]);
+            return;
+        }
+    }
+}
+
+// Settle every parked core so counters and state can be read; they stay parked
+void spin_sync(Simulator *sim) {
+    if (!sim->spin.enabled) return;
+    for (int i = 0; i < NUM_CORES; i++) {
+        if (sim->spin.cores[i].mode == SPIN_PARKED) spin_settle(&sim->spin.cores[i], &sim->cores[i]);
+    }
+}
@@ -57,43 +57,95 @@ static FILE* open_input_file_robust(const char *filename) {
     return NULL;
 }
 
-// File I/O (to be implemented)
-bool load_imem(const char *filename, uint32_t *imem) {
-    FILE *fp;
-    char line[256];
-    int address = 0;
+// Read a whole text file into a NUL-terminated heap buffer
+static char* read_text_file(FILE *fp, size_t *len) {
+    size_t cap = 1 << 16, n = 0;
+    char *buf = (char *)malloc(cap + 1);
+    while (buf) {
+        n += fread(buf + n, 1, cap - n, fp);
+        if (n < cap) break;
+        char *grown = (char *)realloc(buf, cap * 2 + 1);
+        if (!grown) { free(buf); buf = NULL; break; }
+        buf = grown;
+        cap *= 2;
+    }
+    if (buf) buf[n] = '\0';
+    *len = n;
+    return buf;
+}
 
-    // Step 1: Open file for reading
-    fp = open_input_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for reading\n", filename);
-        return false;
+// fgets() over an in-memory text: copies the next line (newline included, at
+// most size-1 chars) into line and advances *pos
+static bool next_text_line(const char *text, size_t len, size_t *pos, char *line, size_t size) {
+    size_t n = 0;
+    if (*pos >= len) return false;
+    while (*pos < len && n + 1 < size) {
+        char c = text[(*pos)++];
+        line[n++] = c;
+        if (c == '\n') break;
     }
+    line[n] = '\0';
+    return true;
+}
 
-    // Step 2: Read line-by-line
-    while (fgets(line, sizeof(line), fp) != NULL && address < IMEM_SIZE) {
+// imemN.txt format: one hex instruction per line; lines that do not parse are
+// skipped and the rest of imem is zero-filled. Returns the instructions read.
+int parse_imem_text(const char *text, size_t len, uint32_t *imem) {
+    char line[256];
+    size_t pos = 0;
+    int address = 0;
+
+    while (address < IMEM_SIZE && next_text_line(text, len, &pos, line, sizeof(line))) {
         uint32_t instruction;
 
-        // Step 3: Parse hexadecimal value (8 hex digits = 32 bits)
+        // Parse hexadecimal value (8 hex digits = 32 bits)
         if (sscanf(line, "%x", &instruction) == 1) {
-            // Step 4: Store in imem array
             imem[address] = instruction;
             address++;
         }
         // If sscanf fails, skip the line (could be empty or malformed)
     }
 
-    // Step 5: Fill remaining addresses with zeros (already done by init)
-    // but let's be explicit for clarity
+    int count = address;
     while (address < IMEM_SIZE) {
         imem[address] = 0;
         address++;
     }
+    return count;
+}
 
-    // Step 6: Close file
+// memin.txt format: one hex word per line from address 0. Returns the words read.
+int parse_memin_text(const char *text, size_t len, MainMemory *mem) {
+    char line[12];
+    size_t pos = 0;
+    int i = 0;
+    while (i < MAIN_MEM_SIZE && next_text_line(text, len, &pos, line, sizeof(line))) {
+        // Parse hex value
+        mem->data[i] = (uint32_t)strtoul(line, NULL, 16);
+        i++;
+    }
+    memory_mark_dirty(mem, 0, (uint32_t)i);
+    return i;
+}
+
+bool load_imem(const char *filename, uint32_t *imem) {
+    FILE *fp = open_input_file_robust(filename);
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for reading\n", filename);
+        return false;
+    }
+
+    size_t len;
+    char *text = read_text_file(fp, &len);
     fclose(fp);
+    if (!text) {
+        fprintf(stderr, "Error: Out of memory reading %s\n", filename);
+        return false;
+    }
+    parse_imem_text(text, len, imem);
+    free(text);
 
-    printf("Loaded %d instructions from %s\n", address, filename);
+    printf("Loaded %d instructions from %s\n", IMEM_SIZE, filename);
     return true;
 }
 
@@ -104,17 +156,91 @@ bool load_memin(const char* filename, MainMemory* mem) {
         return false;
     }
 
-    char line[12];
-    int i = 0;
-    while (fgets(line, sizeof(line), fp) && i < MAIN_MEM_SIZE) {
-        // Parse hex value
-        mem->data[i] = (uint32_t)strtoul(line, NULL, 16);
-        i++;
+    size_t len;
+    char *text = read_text_file(fp, &len);
+    fclose(fp);
+    if (!text) {
+        fprintf(stderr, "Error: Out of memory reading %s\n", filename);
+        return false;
     }
-    
+    parse_memin_text(text, len, mem);
+    free(text);
+    return true;
+}
+
+// One hex word per line, exactly count lines (dsramN.txt / tsramN.txt format)
+static bool load_hex_words(const char *filename, uint32_t *words, int count) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open %s for reading\n", filename);
+        return false;
+    }
+    size_t len;
+    char *text = read_text_file(fp, &len);
     fclose(fp);
+    if (!text) {
+        fprintf(stderr, "Error: Out of memory reading %s\n", filename);
+        return false;
+    }
+
+    char line[64];
+    size_t pos = 0;
+    int n = 0;
+    while (next_text_line(text, len, &pos, line, sizeof(line))) {
+        char *end;
+        unsigned long value = strtoul(line, &end, 16);
+        if (end == line) continue;      // Blank line
+        if (n == count) {
+            n++;
+            break;
+        }
+        words[n++] = (uint32_t)value;
+    }
+    free(text);
+    if (n != count) {
+        fprintf(stderr, "Error: %s must hold %d words\n", filename, count);
+        return false;
+    }
+    return true;
+}
+
+bool load_dsram(const char *filename, Cache *cache) {
+    return load_hex_words(filename, cache->dsram, CACHE_SIZE);
+}
+
+bool load_tsram(const char *filename, TagDirectory *tags, int core_id) {
+    uint32_t entries[NUM_CACHE_BLOCKS];
+    if (!load_hex_words(filename, entries, NUM_CACHE_BLOCKS)) return false;
+    for (int i = 0; i < NUM_CACHE_BLOCKS; i++) {
+        if (entries[i] >> (TSRAM_STATE_SHIFT + 2)) {
+            fprintf(stderr, "Error: %s line %d: %08X is not a tag + MESI entry\n", filename, i + 1, entries[i]);
+            return false;
+        }
+        tag_dir_set(tags, i, core_id, (TSRAMEntry)entries[i]);
+    }
     return true;
 }
+
+// Power-on state replaced by an earlier run's end state: DIR/memout.txt and
+// each core's DIR/dsramN.txt + DIR/tsramN.txt (pipelines and registers stay
+// at reset). The images must be MESI-consistent (check_cache_coherence).
+bool load_warm_start(Simulator *sim, const char *dir) {
+    char path[1024];
+
+    // memout.txt stops at the last non-zero word: clear what memin loaded
+    init_main_memory(&sim->main_memory);
+    snprintf(path, sizeof(path), "%s/memout.txt", dir);
+    if (!load_memin(path, &sim->main_memory)) return false;
+
+    for (int i = 0; i < NUM_CORES; i++) {
+        snprintf(path, sizeof(path), "%s/dsram%d.txt", dir, i);
+        if (!load_dsram(path, &sim->cores[i].cache)) return false;
+        snprintf(path, sizeof(path), "%s/tsram%d.txt", dir, i);
+        if (!load_tsram(path, &sim->tags, i)) return false;
+    }
+    return check_cache_coherence(sim);
+}
+
 // Helper to handle output directory creation if writing to outputs/
 static FILE* open_output_file_robust(const char *filename) {
     FILE *fp = NULL;
@@ -154,14 +280,32 @@ static FILE* open_output_file_robust(const char *filename) {
     return fopen(basename, "w");
 }
 
-bool save_memout(const char *filename, MainMemory *mem) {
-    FILE *fp;
+// Build "<directory of sibling>/<name>" so auxiliary reports land next to the
+// regular output files (e.g. perf.json next to stats0.txt)
+bool make_sibling_path(const char *sibling, const char *name, char *path, size_t size) {
+    const char *slash = strrchr(sibling, '/');
+    const char *backslash = strrchr(sibling, '\\');
+    if (backslash && (!slash || backslash > slash)) slash = backslash;
 
-    fp = open_output_file_robust(filename);
-    if (!fp) {
+    size_t dir_len = slash ? (size_t)(slash - sibling + 1) : 0;
+    int written = snprintf(path, size, "%.*s%s", (int)dir_len, sibling, name);
+    return written > 0 && (size_t)written < size;
+}
+
+// Open an output file and attach a write buffer to it
+static bool open_output_buffer(const char *filename, OutBuf *ob) {
+    FILE *fp = open_output_file_robust(filename);
+    if (!fp || !outbuf_open(ob, fp)) {
         fprintf(stderr, "Error: Could not open %s for writing\n", filename);
         return false;
     }
+    return true;
+}
+
+bool save_memout(const char *filename, MainMemory *mem) {
+    OutBuf ob;
+
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Find last non-zero address for sparse memory output
     int last_addr = 0;
@@ -175,135 +319,100 @@ bool save_memout(const char *filename, MainMemory *mem) {
     // Write only up to last non-zero address (minimum 64 words to match reference format)
     int write_count = (last_addr < 63) ? 64 : last_addr + 1;
     for (int i = 0; i < write_count; i++) {
-        fprintf(fp, "%08X\n", mem->data[i]);
+        outbuf_hex_line(&ob, mem->data[i]);
     }
 
-    fclose(fp);
-    return true;
+    return outbuf_close(&ob);
 }
 
 bool save_regout(const char *filename, Core *core) {
-    FILE *fp;
+    OutBuf ob;
 
-    // Open file for writing
-    fp = open_output_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
-        return false;
-    }
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Write registers R2 through R15 (skip R0 and R1)
     // R0 = always zero, R1 = immediate register
     for (int i = 2; i < NUM_REGISTERS; i++) {
-        fprintf(fp, "%08X\n", core->registers[i]);
+        outbuf_hex_line(&ob, core->registers[i]);
     }
 
-    fclose(fp);
-    return true;
+    return outbuf_close(&ob);
+}
+
+static void write_trace_lines(OutBuf *ob, char (*lines)[TRACE_LINE_SIZE], int count) {
+    for (int i = 0; i < count; i++) {
+        outbuf_write(ob, lines[i], strlen(lines[i]));
+        outbuf_write(ob, "\n", 1);
+    }
 }
 
 bool save_trace(const char *filename, Core *core) {
-    FILE *fp;
+    OutBuf ob;
 
-    fp = open_output_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
-        return false;
-    }
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Write all buffered trace lines
     // These are generated during simulation in the pipeline code
-    for (int i = 0; i < core->trace_count; i++) {
-        if (i == 7) printf("DEBUG SAVE_TRACE: Idx 7 = %s\n", core->trace_lines[i]);
-        fprintf(fp, "%s\n", core->trace_lines[i]);
-    }
+    write_trace_lines(&ob, core->trace_lines, core->trace_count);
 
-    fclose(fp);
-    return true;
+    return outbuf_close(&ob);
 }
 
 bool save_bustrace(const char *filename, BusArbiter *bus) {
-    FILE *fp;
+    OutBuf ob;
 
-    fp = open_output_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
-        return false;
-    }
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Write all buffered bus trace lines
-    for (int i = 0; i < bus->trace_count; i++) {
-        fprintf(fp, "%s\n", bus->trace_lines[i]);
-    }
+    write_trace_lines(&ob, bus->trace_lines, bus->trace_count);
 
-    fclose(fp);
-    return true;
+    return outbuf_close(&ob);
 }
 
 bool save_dsram(const char *filename, Cache *cache) {
-    FILE *fp;
+    OutBuf ob;
 
-    fp = open_output_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
-        return false;
-    }
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Write all 512 words of cache data (DSRAM)
     for (int i = 0; i < CACHE_SIZE; i++) {
-        fprintf(fp, "%08X\n", cache->dsram[i]);
+        outbuf_hex_line(&ob, cache->dsram[i]);
     }
 
-    fclose(fp);
-    return true;
+    return outbuf_close(&ob);
 }
 
-bool save_tsram(const char *filename, Cache *cache) {
-    FILE *fp;
+bool save_tsram(const char *filename, const TagDirectory *tags, int core_id) {
+    OutBuf ob;
 
-    fp = open_output_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
-        return false;
-    }
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Write all 64 TSRAM entries (tag + MESI state)
     // Format: bits[13:12] = MESI, bits[11:0] = tag, bits[31:14] = 0
+    // TSRAMEntry already holds the packed word
     for (int i = 0; i < NUM_CACHE_BLOCKS; i++) {
-        uint32_t tsram_word = 0;
-
-        // Pack MESI state (2 bits) and tag (12 bits) into lower 14 bits
-        tsram_word = ((uint32_t)cache->tsram[i].mesi_state << 12) |
-                     (cache->tsram[i].tag & 0x0FFF);
-
-        fprintf(fp, "%08X\n", tsram_word);
+        outbuf_hex_line(&ob, tag_dir_get(tags, i, core_id));
     }
 
-    fclose(fp);
-    return true;
+    return outbuf_close(&ob);
 }
 
 bool save_stats(const char *filename, Core *core) {
-    FILE *fp;
+    OutBuf ob;
 
-    fp = open_output_file_robust(filename);
-    if (!fp) {
-        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
-        return false;
-    }
+    if (!open_output_buffer(filename, &ob)) return false;
 
     // Write statistics in required format (name value pairs, decimal)
-    fprintf(fp, "cycles %llu\n", core->cycles);
-    fprintf(fp, "instructions %llu\n", core->instructions);
-    fprintf(fp, "read_hit %llu\n", core->read_hit);
-    fprintf(fp, "write_hit %llu\n", core->write_hit);
-    fprintf(fp, "read_miss %llu\n", core->read_miss);
-    fprintf(fp, "write_miss %llu\n", core->write_miss);
-    fprintf(fp, "decode_stall %llu\n", core->decode_stall);
-    fprintf(fp, "mem_stall %llu\n", core->mem_stall);
-
-    fclose(fp);
-    return true;
+    outbuf_stat_line(&ob, "cycles", core->cycles);
+    outbuf_stat_line(&ob, "instructions", core->instructions);
+    outbuf_stat_line(&ob, "read_hit", core->read_hit);
+    outbuf_stat_line(&ob, "write_hit", core->write_hit);
+    outbuf_stat_line(&ob, "read_miss", core->read_miss);
+    outbuf_stat_line(&ob, "write_miss", core->write_miss);
+    outbuf_stat_line(&ob, "decode_stall", core->decode_stall);
+    outbuf_stat_line(&ob, "mem_stall", core->mem_stall);
+
+    return outbuf_close(&ob);
 }
 
 // Simulation control
@@ -311,32 +420,59 @@ void run_simulator(Simulator *sim) {
     printf("Running simulator...\n");
 
     // Run until all cores are halted and all pipelines are empty
-    while (!all_cores_halted(sim) || !all_pipelines_empty(sim)) {
-        // Execute bus cycle (arbitration and snooping)
-        bus_cycle(sim);
-
-        // Execute memory cycle (handle pending memory transactions)
-        memory_cycle(&sim->main_memory, &sim->bus.current, sim);
-
-        // Execute one cycle for each core
-        for (int i = 0; i < NUM_CORES; i++) {
-            execute_core_cycle(&sim->cores[i], sim);
-        }
-
-        // Increment global cycle counter AFTER executing
-        // This ensures trace numbering starts at 0 while first fetch happens during cycle 1
-        sim->global_cycle++;
+    while (!simulation_done(sim)) {
+        simulate_cycle(sim);
 
         // Safety limit to prevent infinite loops during development
-        if (sim->global_cycle > 100000) {
-            printf("Warning: Simulation stopped after 100000 cycles\n");
+        if (sim->global_cycle > MAX_SIM_CYCLES) {
+            printf("Warning: Simulation stopped after %d cycles\n", MAX_SIM_CYCLES);
             break;
         }
     }
 
+    // A run stopped mid-fill still shows the words already transferred
+    bus_sync_flush(sim);
+    spin_sync(sim);
+
     printf("Simulation complete\n");
 }
 
+// One clock cycle of the whole system (also the unit of simlib_step)
+void simulate_cycle(Simulator *sim) {
+#if SIM_PROFILE
+    if (profile_enabled) profile_sample(sim->global_cycle);
+#endif
+
+    trace_cycle_begin(sim);
+    if (sim->cosim.enabled && !sim->cosim.started) cosim_start(sim);
+    if (sim->fingerprint.enabled) fingerprint_cycle(&sim->fingerprint, sim->global_cycle);
+
+    // Execute bus cycle (arbitration and snooping)
+    PROFILE_BEGIN(PROF_BUS_CYCLE);
+    bus_cycle(sim);
+    PROFILE_END(PROF_BUS_CYCLE);
+
+    // Execute memory cycle (handle pending memory transactions)
+    memory_cycle(&sim->main_memory, &sim->bus.current, sim);
+
+    // Execute one cycle for each core
+    for (int i = 0; i < NUM_CORES; i++) {
+        execute_core_cycle(&sim->cores[i], sim);
+    }
+    if (sim->timeline.enabled) timeline_cycle(sim);
+
+    // Increment global cycle counter AFTER executing
+    // This ensures trace numbering starts at 0 while first fetch happens during cycle 1
+    sim->global_cycle++;
+    if (sim->intervals.enabled && sim->global_cycle >= sim->intervals.next) interval_snapshot(sim);
+}
+
+// All cores halted and all pipelines drained
+bool simulation_done(Simulator *sim) {
+    if (sim->cosim.failed) return true;  // Stopped at the first co-simulation mismatch
+    return all_cores_halted(sim) && all_pipelines_empty(sim);
+}
+
 bool all_cores_halted(Simulator *sim) {
     for (int i = 0; i < NUM_CORES; i++) {
         if (!sim->cores[i].halted) {
@@ -348,6 +484,9 @@ bool all_cores_halted(Simulator *sim) {
 
 bool all_pipelines_empty(Simulator* sim) {
     for (int i = 0; i < NUM_CORES; i++) {
+        // A halted core never advances again; whatever it fetched behind the
+        // HALT stays latched but is dead, so it must not keep the run alive
+        if (sim->cores[i].halted) continue;
         Pipeline* p = &sim->cores[i].pipeline;
         // The simulator only exits when ALL these are false 
         if (p->fetch.valid || p->decode.valid || p->execute.valid ||
@@ -369,6 +508,18 @@ static void get_asm_reg_name(int reg, char *buffer) {
     }
 }
 
+// Format matches imem0.asm: \t<op> <rd>, <rs>, <rt>, <imm>\t\t# PC=<pc>
+void format_assembly_line(uint32_t inst_word, int pc, char *buffer) {
+    Instruction inst = decode_instruction(inst_word);
+    char rd_str[16], rs_str[16], rt_str[16];
+
+    get_asm_reg_name(inst.rd, rd_str);
+    get_asm_reg_name(inst.rs, rs_str);
+    get_asm_reg_name(inst.rt, rt_str);
+    sprintf(buffer, "\t%s %s, %s, %s, %d\t\t# PC=%d",
+            get_opcode_name(inst.opcode), rd_str, rs_str, rt_str, inst.imm, pc);
+}
+
 bool save_assembly(const char *filename, uint32_t *imem, int size) {
     FILE *fp;
 
@@ -387,20 +538,10 @@ bool save_assembly(const char *filename, uint32_t *imem, int size) {
         }
     }
 
-    char rd_str[16], rs_str[16], rt_str[16];
-
+    char line[128];
     for (int pc = 0; pc <= last_addr; pc++) {
-        Instruction inst = decode_instruction(imem[pc]);
-        
-        get_asm_reg_name(inst.rd, rd_str);
-        get_asm_reg_name(inst.rs, rs_str);
-        get_asm_reg_name(inst.rt, rt_str);
-
-        // Format matches imem0.asm: \t<op> <rd>, <rs>, <rt>, <imm>\t\t# PC=<pc>
-        fprintf(fp, "\t%s %s, %s, %s, %d\t\t# PC=%d\n", 
-                get_opcode_name(inst.opcode),
-                rd_str, rs_str, rt_str, inst.imm,
-                pc);
+        format_assembly_line(imem[pc], pc, line);
+        fprintf(fp, "%s\n", line);
     }
 
     fclose(fp);
@@ -0,0 +1,213 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// TIMELINE EXPORT (--timeline FILE)
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) with one process
+// per core and one for the bus, 1 us on the time axis per cycle:
+// - core tracks: IF..WB occupancy ("lw 004"), decode stalls, miss lifetimes
+//   (the MEM stall of one access) and bus waits (requested, not granted);
+// - bus tracks: one span per transaction, grant through last flush word, and
+//   its phases from bus_cycle's state machine.
+// The state is sampled once per cycle, after the cores. A track keeps one open
+// span and extends it while the sample stays the same, so a stalled
+// instruction or a 16-cycle memory latency is a single event. Events are
+// written as spans close; the file is finished by timeline_close().
+// Stage occupancy is about five events per instruction and dominates the file
+// (~40 MB per 100k cycles of four busy cores); with --trace-window it is only
+// exported inside the windows, the other tracks always cover the whole run.
+// ====================================================================================
+
+static const char *STAGE_NAMES[5] = { "IF", "ID", "EX", "MEM", "WB" };
+
+enum { TL_PHASE_ARBITRATION = 0, TL_PHASE_REQUEST, TL_PHASE_LATENCY, TL_PHASE_FLUSH };
+static const char *PHASE_NAMES[] = { "arbitration", "request", "latency", "flush" };
+
+#define TL_BUS_PID NUM_CORES
+#define TL_WRITE_BIT 0x80000000u      // Miss key: SW
+#define TL_PARITY_BIT 0x80000000u     // Transaction key: odd grant
+
+static void write_event_start(TimelineExport *tl) {
+    fputs(tl->first ? "\n" : ",\n", tl->fp);
+    tl->first = false;
+}
+
+static void write_metadata(TimelineExport *tl, int pid, int tid, const char *kind, const char *name) {
+    write_event_start(tl);
+    if (tid < 0) fprintf(tl->fp, "{\"ph\":\"M\",\"pid\":%d,\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}", pid, kind, name);
+    else fprintf(tl->fp, "{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}",
+                 pid, tid, kind, name);
+}
+
+bool timeline_init(TimelineExport *tl, const char *filename) {
+    memset(tl, 0, sizeof(TimelineExport));
+    tl->fp = fopen(filename, "w");
+    if (!tl->fp) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+    setvbuf(tl->fp, NULL, _IOFBF, 1 << 20);
+    for (int i = 0; i < NUM_CORES; i++) {
+        for (int t = 0; t < TL_CORE_TRACKS; t++) tl->core[i][t].key = TL_NO_SPAN;
+    }
+    for (int t = 0; t < TL_BUS_TRACKS; t++) tl->bus[t].key = TL_NO_SPAN;
+    tl->bus_state = BUS_STATE_IDLE;
+    tl->first = true;
+    tl->enabled = true;
+
+    fprintf(tl->fp, "{\"otherData\":{\"time_unit\":\"1 us = 1 cycle\"},\"traceEvents\":[");
+    char name[32];
+    for (int i = 0; i < NUM_CORES; i++) {
+        sprintf(name, "Core %d", i);
+        write_metadata(tl, i, -1, "process_name", name);
+        for (int s = 0; s < 5; s++) write_metadata(tl, i, TL_TRACK_IF + s, "thread_name", STAGE_NAMES[s]);
+        write_metadata(tl, i, TL_TRACK_STALL, "thread_name", "decode stall");
+        write_metadata(tl, i, TL_TRACK_MISS, "thread_name", "miss");
+        write_metadata(tl, i, TL_TRACK_BUS_WAIT, "thread_name", "bus wait");
+    }
+    write_metadata(tl, TL_BUS_PID, -1, "process_name", "Bus");
+    write_metadata(tl, TL_BUS_PID, TL_TRACK_TRANSACTION, "thread_name", "transaction");
+    write_metadata(tl, TL_BUS_PID, TL_TRACK_PHASE, "thread_name", "phase");
+    return true;
+}
+
+// ====================================================================================
+// SPANS
+// ====================================================================================
+
+// Write the span as one complete ("X") event ending before cycle end
+static void emit_span(Simulator *sim, int pid, int tid, const TimelineSpan *span, uint64_t end) {
+    TimelineExport *tl = &sim->timeline;
+    char name[32], args[96];
+    args[0] = '\0';
+
+    if (pid == TL_BUS_PID && tid == TL_TRACK_TRANSACTION) {
+        int owner = (span->key >> 21) & 0x7;
+        int cmd = (span->key >> 24) & 0x3;
+        sprintf(name, "%s core %d", cmd == BUS_RDX ? "BusRdX" : "BusRd", owner);
+        if (span->arg < NUM_CORES) {
+            sprintf(args, ",\"args\":{\"addr\":\"%06X\",\"supplier\":\"core %u\"}", span->key & 0x1FFFFF, span->arg);
+        } else {
+            sprintf(args, ",\"args\":{\"addr\":\"%06X\",\"supplier\":\"memory\"}", span->key & 0x1FFFFF);
+        }
+    } else if (pid == TL_BUS_PID) {
+        strcpy(name, PHASE_NAMES[span->key]);
+    } else if (tid < 5) {
+        Instruction inst = decode_instruction(sim->cores[pid].imem[span->key & (IMEM_SIZE - 1)]);
+        sprintf(name, "%s %03X", get_opcode_name(inst.opcode), span->key);
+    } else if (tid == TL_TRACK_STALL) {
+        strcpy(name, "decode stall");
+    } else if (tid == TL_TRACK_MISS) {
+        strcpy(name, (span->key & TL_WRITE_BIT) ? "SW miss" : "LW miss");
+        sprintf(args, ",\"args\":{\"pc\":\"%03X\",\"addr\":\"%06X\"}", span->arg, span->key & ~TL_WRITE_BIT);
+    } else {
+        strcpy(name, "bus wait");
+    }
+
+    write_event_start(tl);
+    fprintf(tl->fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%llu,\"dur\":%llu%s}", name, pid, tid,
+            (unsigned long long)span->start, (unsigned long long)(end - span->start), args);
+    tl->events++;
+}
+
+// This cycle's sample of a track: extend the open span or replace it
+static void track(Simulator *sim, int pid, int tid, TimelineSpan *span, uint32_t key, uint32_t arg) {
+    if (span->key == key) return;
+    uint64_t now = sim->global_cycle;
+    if (span->key != TL_NO_SPAN) emit_span(sim, pid, tid, span, now);
+    span->key = key;
+    span->arg = arg;
+    span->start = now;
+}
+
+// ====================================================================================
+// SAMPLING
+// ====================================================================================
+
+static void sample_core(Simulator *sim, Core *core, bool in_window) {
+    TimelineExport *tl = &sim->timeline;
+    int id = core->core_id;
+    TimelineSpan *spans = tl->core[id];
+    Pipeline *p = &core->pipeline;
+
+    if (core->halted) {
+        for (int t = 0; t < TL_CORE_TRACKS; t++) track(sim, id, t, &spans[t], TL_NO_SPAN, 0);
+        return;
+    }
+
+    const PipelineReg *stages[5] = { &p->fetch, &p->decode, &p->execute, &p->mem, &p->writeback };
+    for (int s = 0; s < 5; s++) {
+        bool show = stages[s]->valid && in_window;
+        track(sim, id, TL_TRACK_IF + s, &spans[TL_TRACK_IF + s], show ? stages[s]->pc : TL_NO_SPAN, 0);
+    }
+
+    bool decode_stalled = core->decode_stall != tl->decode_stall[id];
+    track(sim, id, TL_TRACK_STALL, &spans[TL_TRACK_STALL], decode_stalled ? 0 : TL_NO_SPAN, 0);
+
+    uint32_t miss = TL_NO_SPAN;
+    if (core->mem_stall != tl->mem_stall[id] && p->mem.valid) {
+        miss = (p->mem.alu_result & (MAIN_MEM_SIZE - 1)) | (p->mem.inst.opcode == OP_SW ? TL_WRITE_BIT : 0);
+    }
+    track(sim, id, TL_TRACK_MISS, &spans[TL_TRACK_MISS], miss, p->mem.pc);
+
+    track(sim, id, TL_TRACK_BUS_WAIT, &spans[TL_TRACK_BUS_WAIT], sim->bus.pending[id] ? 0 : TL_NO_SPAN, 0);
+
+    tl->decode_stall[id] = core->decode_stall;
+    tl->mem_stall[id] = core->mem_stall;
+}
+
+// What the bus did this cycle follows from its state before and after bus_cycle
+static void sample_bus(Simulator *sim) {
+    TimelineExport *tl = &sim->timeline;
+    BusArbiter *bus = &sim->bus;
+    BusState entry = tl->bus_state, end = bus->state;
+
+    uint32_t phase = TL_NO_SPAN;
+    if (entry == BUS_STATE_IDLE) {
+        if (end != BUS_STATE_IDLE) {
+            // Granted: a new transaction span (the grant parity keeps back-to-back ones apart)
+            const BusTransaction *t = &bus->pending_trans[bus->owner];
+            uint32_t key = (t->addr & 0x1FFFFF) | ((uint32_t)bus->owner << 21) | ((uint32_t)t->cmd << 24) |
+                           ((tl->grants++ & 1) ? TL_PARITY_BIT : 0);
+            track(sim, TL_BUS_PID, TL_TRACK_TRANSACTION, &tl->bus[TL_TRACK_TRANSACTION], key, NUM_CORES);
+            phase = TL_PHASE_ARBITRATION;
+        } else {
+            track(sim, TL_BUS_PID, TL_TRACK_TRANSACTION, &tl->bus[TL_TRACK_TRANSACTION], TL_NO_SPAN, 0);
+        }
+    } else if (entry == BUS_STATE_ARBITRATE || entry == BUS_STATE_REQUEST) {
+        phase = TL_PHASE_REQUEST;
+        tl->bus[TL_TRACK_TRANSACTION].arg = (uint32_t)bus->provider_id;
+    } else if (entry == BUS_STATE_LATENCY && end == BUS_STATE_LATENCY) {
+        phase = TL_PHASE_LATENCY;
+    } else {
+        phase = TL_PHASE_FLUSH;
+    }
+    track(sim, TL_BUS_PID, TL_TRACK_PHASE, &tl->bus[TL_TRACK_PHASE], phase, 0);
+    tl->bus_state = end;
+}
+
+// Called at the end of every simulated cycle
+void timeline_cycle(Simulator *sim) {
+    const TraceConfig *cfg = &sim->options.trace;
+    bool in_window = !cfg->num_windows || trace_cycle_in_windows(cfg, sim->global_cycle);
+    sample_bus(sim);
+    for (int i = 0; i < NUM_CORES; i++) sample_core(sim, &sim->cores[i], in_window);
+}
+
+// Emit the open spans up to the current cycle and finish the JSON document
+void timeline_close(Simulator *sim) {
+    TimelineExport *tl = &sim->timeline;
+    if (!tl->enabled) return;
+    for (int i = 0; i < NUM_CORES; i++) {
+        for (int t = 0; t < TL_CORE_TRACKS; t++) track(sim, i, t, &tl->core[i][t], TL_NO_SPAN, 0);
+    }
+    for (int t = 0; t < TL_BUS_TRACKS; t++) track(sim, TL_BUS_PID, t, &tl->bus[t], TL_NO_SPAN, 0);
+    fprintf(tl->fp, "\n]}\n");
+    fclose(tl->fp);
+    memset(tl, 0, sizeof(TimelineExport));
+}
@@ -0,0 +1,131 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+// ====================================================================================
+// TRACE CONTROL
+// Every trace record goes through trace_claim_line(), which returns the buffer
+// line to format into or NULL when the record is filtered out (stream disabled,
+// outside every --trace-window, buffer full). A NULL return skips all
+// formatting work.
+//
+// With a trigger configured the streams start "armed": each one keeps its last
+// pre_cycles + 1 records in a ring placed just past its committed lines. When
+// a trigger fires, the rings are rotated into order and committed, and every
+// record is kept until post_cycles after the (last) trigger. Then the streams
+// re-arm.
+// ====================================================================================
+
+static bool trace_triggered_mode(const TraceConfig *cfg) {
+    return cfg->trigger_pc_enabled || cfg->trigger_addr_enabled;
+}
+
+bool trace_cycle_in_windows(const TraceConfig *cfg, uint64_t cycle) {
+    for (int i = 0; i < cfg->num_windows; i++) {
+        if (cycle >= cfg->windows[i].start && cycle <= cfg->windows[i].end) return true;
+    }
+    return false;
+}
+
+char* trace_claim_line(Simulator *sim, int stream, char (*lines)[TRACE_LINE_SIZE], int *count, TraceRing *ring) {
+    const TraceConfig *cfg = &sim->options.trace;
+    uint64_t cycle = sim->global_cycle;
+
+    if (cfg->disabled_streams & (1u << stream)) return NULL;
+    if (cfg->num_windows && !trace_cycle_in_windows(cfg, cycle)) return NULL;
+
+    if (!trace_triggered_mode(cfg) || sim->trace.capturing) {
+        if (*count >= MAX_TRACE_LINES) return NULL;
+        return lines[(*count)++];
+    }
+
+    // Armed: overwrite the oldest ring entry once the ring is full
+    int capacity = (int)cfg->pre_cycles + 1;
+    if (*count + capacity > MAX_TRACE_LINES) return NULL;
+    if (ring->len < capacity) return lines[*count + ring->len++];
+
+    char *line = lines[*count + ring->head];
+    ring->head = (ring->head + 1) % capacity;
+    return line;
+}
+
+static void reverse_lines(char (*lines)[TRACE_LINE_SIZE], int from, int to) {
+    char tmp[TRACE_LINE_SIZE];
+    for (to--; from < to; from++, to--) {
+        memcpy(tmp, lines[from], TRACE_LINE_SIZE);
+        memcpy(lines[from], lines[to], TRACE_LINE_SIZE);
+        memcpy(lines[to], tmp, TRACE_LINE_SIZE);
+    }
+}
+
+// Put the ring in cycle order and append the records from first_cycle onwards
+static void commit_ring(char (*lines)[TRACE_LINE_SIZE], int *count, TraceRing *ring, uint64_t first_cycle) {
+    char (*base)[TRACE_LINE_SIZE] = lines + *count;
+
+    if (ring->head) {
+        // Rotate left by head (three reversals, in place)
+        reverse_lines(base, 0, ring->head);
+        reverse_lines(base, ring->head, ring->len);
+        reverse_lines(base, 0, ring->len);
+    }
+
+    // Both trace formats start with the cycle number
+    int skip = 0;
+    while (skip < ring->len && strtoull(base[skip], NULL, 10) < first_cycle) skip++;
+    if (skip) memmove(base, base + skip, (size_t)(ring->len - skip) * TRACE_LINE_SIZE);
+
+    *count += ring->len - skip;
+    ring->len = 0;
+    ring->head = 0;
+}
+
+static void trace_fire(Simulator *sim) {
+    const TraceConfig *cfg = &sim->options.trace;
+    uint64_t cycle = sim->global_cycle;
+    uint64_t end = cycle + cfg->post_cycles;
+
+    if (sim->trace.capturing) {
+        // Re-trigger inside a capture extends it
+        if (end > sim->trace.capture_end) sim->trace.capture_end = end;
+        return;
+    }
+
+    uint64_t first = (cycle > cfg->pre_cycles) ? cycle - cfg->pre_cycles : 0;
+    for (int i = 0; i < NUM_CORES; i++) {
+        Core *core = &sim->cores[i];
+        commit_ring(core->trace_lines, &core->trace_count, &core->trace_ring, first);
+    }
+    commit_ring(sim->bus.trace_lines, &sim->bus.trace_count, &sim->bus.trace_ring, first);
+
+    sim->trace.capturing = true;
+    sim->trace.capture_end = end;
+    sim->trace.triggers++;
+}
+
+// Called at the start of every simulated cycle: ends a finished capture and re-arms
+void trace_cycle_begin(Simulator *sim) {
+    if (!sim->trace.capturing || sim->global_cycle <= sim->trace.capture_end) return;
+
+    sim->trace.capturing = false;
+    for (int i = 0; i < NUM_CORES; i++) {
+        sim->cores[i].trace_ring.len = 0;
+        sim->cores[i].trace_ring.head = 0;
+    }
+    sim->bus.trace_ring.len = 0;
+    sim->bus.trace_ring.head = 0;
+}
+
+void trace_check_pc(Simulator *sim, int core_id, uint16_t pc) {
+    const TraceConfig *cfg = &sim->options.trace;
+    if (cfg->trigger_pc_core >= 0 && cfg->trigger_pc_core != core_id) return;
+    if (pc == cfg->trigger_pc) trace_fire(sim);
+}
+
+void trace_check_addr(Simulator *sim, uint32_t addr) {
+    const TraceConfig *cfg = &sim->options.trace;
+    if ((addr & (MAIN_MEM_SIZE - 1)) == (cfg->trigger_addr & (MAIN_MEM_SIZE - 1))) trace_fire(sim);
+}
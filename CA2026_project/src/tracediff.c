@@ -0,0 +1,684 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+// Native output comparator. Built as its own executable (make tracediff /
+// scripts\compile_tracediff.bat) and does not link the simulator.
+//
+//   tracediff [options] <generated_dir> <reference_dir>   - all 22 output files
+//   tracediff [options] <generated_file> <reference_file> - one file
+//
+// Files are memory-mapped and compared field by field (whitespace-insensitive,
+// like "fc /w" in compare_outputs.ps1), one worker thread per file. At the
+// first divergence of a trace file the cycle, stage PCs, register differences
+// and the surrounding bus transactions of both runs are printed.
+//
+// Exit code: 0 all match, 1 differences found, 2 error.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define MAX_FIELDS 24
+#define MAX_LINE_COPY 512
+#define MAX_PATH_LEN 1024
+#define MAX_JOBS 32
+#define DEFAULT_CONTEXT 8
+
+// ====================================================================================
+// PLATFORM SHIMS (file mapping, threads)
+// ====================================================================================
+
+typedef struct {
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE map;
+#endif
+} MappedFile;
+
+static bool map_file(const char *path, MappedFile *m) {
+    memset(m, 0, sizeof(MappedFile));
+#ifdef _WIN32
+    m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                          FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    GetFileSizeEx(m->file, &size);
+    m->size = (size_t)size.QuadPart;
+    if (m->size == 0) {
+        m->data = "";
+        return true;
+    }
+    m->map = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m->map) {
+        CloseHandle(m->file);
+        return false;
+    }
+    m->data = (const char *)MapViewOfFile(m->map, FILE_MAP_READ, 0, 0, 0);
+    return m->data != NULL;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    m->size = (size_t)st.st_size;
+    if (m->size == 0) {
+        close(fd);
+        m->data = "";
+        return true;
+    }
+    void *p = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    madvise(p, m->size, MADV_SEQUENTIAL);
+    m->data = (const char *)p;
+    return true;
+#endif
+}
+
+static void unmap_file(MappedFile *m) {
+    if (m->size == 0) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m->data);
+    CloseHandle(m->map);
+    CloseHandle(m->file);
+#else
+    munmap((void *)m->data, m->size);
+#endif
+    m->data = NULL;
+    m->size = 0;
+}
+
+#ifdef _WIN32
+typedef HANDLE thread_t;
+typedef DWORD thread_ret_t;
+#define THREAD_CALL WINAPI
+#else
+typedef pthread_t thread_t;
+typedef void *thread_ret_t;
+#define THREAD_CALL
+#endif
+
+typedef thread_ret_t (THREAD_CALL *thread_fn_t)(void *);
+
+static bool thread_start(thread_t *t, thread_fn_t fn, void *arg) {
+#ifdef _WIN32
+    *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *t != NULL;
+#else
+    return pthread_create(t, NULL, fn, arg) == 0;
+#endif
+}
+
+static void thread_join(thread_t t) {
+#ifdef _WIN32
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+#else
+    pthread_join(t, NULL);
+#endif
+}
+
+static long atomic_fetch_inc(volatile long *p) {
+#ifdef _WIN32
+    return InterlockedIncrement(p) - 1;
+#else
+    return __sync_fetch_and_add(p, 1);
+#endif
+}
+
+// ====================================================================================
+// LINES AND FIELDS
+// ====================================================================================
+
+typedef struct {
+    const char *p;
+    const char *end;
+    size_t line;        // 1-based number of the last line returned
+} LineReader;
+
+typedef struct {
+    const char *s;
+    int len;
+} Field;
+
+static void reader_init(LineReader *r, const MappedFile *m) {
+    r->p = m->data;
+    r->end = m->data + m->size;
+    r->line = 0;
+}
+
+// Returns the next line without its terminator ("\n" or "\r\n")
+static bool next_line(LineReader *r, const char **start, const char **stop) {
+    if (r->p >= r->end) return false;
+    const char *nl = memchr(r->p, '\n', (size_t)(r->end - r->p));
+    const char *e = nl ? nl : r->end;
+    *start = r->p;
+    *stop = (e > r->p && e[-1] == '\r') ? e - 1 : e;
+    r->p = nl ? nl + 1 : r->end;
+    r->line++;
+    return true;
+}
+
+static int split_fields(const char *s, const char *e, Field *fields, int max) {
+    int n = 0;
+    while (s < e && n < max) {
+        while (s < e && isspace((unsigned char)*s)) s++;
+        if (s >= e) break;
+        const char *f = s;
+        while (s < e && !isspace((unsigned char)*s)) s++;
+        fields[n].s = f;
+        fields[n].len = (int)(s - f);
+        n++;
+    }
+    return n;
+}
+
+static bool field_equal(const Field *a, const Field *b) {
+    if (a->len != b->len) return false;
+    for (int i = 0; i < a->len; i++) {
+        if (toupper((unsigned char)a->s[i]) != toupper((unsigned char)b->s[i])) return false;
+    }
+    return true;
+}
+
+static unsigned long field_hex(const Field *f) {
+    char buf[32];
+    int len = f->len < 31 ? f->len : 31;
+    memcpy(buf, f->s, len);
+    buf[len] = '\0';
+    return strtoul(buf, NULL, 16);
+}
+
+static long long field_dec(const Field *f) {
+    char buf[32];
+    int len = f->len < 31 ? f->len : 31;
+    memcpy(buf, f->s, len);
+    buf[len] = '\0';
+    return strtoll(buf, NULL, 10);
+}
+
+static void copy_line(char *dst, const char *s, const char *e) {
+    size_t len = (size_t)(e - s);
+    if (len >= MAX_LINE_COPY) len = MAX_LINE_COPY - 1;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+}
+
+// ====================================================================================
+// FILE KINDS
+// ====================================================================================
+
+typedef enum {
+    KIND_TEXT,
+    KIND_CORE_TRACE,
+    KIND_BUS_TRACE,
+    KIND_MEMOUT,
+    KIND_REGOUT,
+    KIND_DSRAM,
+    KIND_TSRAM,
+    KIND_STATS
+} FileKind;
+
+static const char *CORE_TRACE_COLUMNS[] = {
+    "cycle", "IF", "ID", "EX", "MEM", "WB",
+    "R2", "R3", "R4", "R5", "R6", "R7", "R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15"
+};
+static const char *BUS_TRACE_COLUMNS[] = { "cycle", "origid", "cmd", "addr", "data", "shared" };
+static const char *STATS_COLUMNS[] = { "name", "value" };
+
+static const char *base_name(const char *path) {
+    const char *b = path;
+    for (const char *p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') b = p + 1;
+    }
+    return b;
+}
+
+static FileKind detect_kind(const char *path) {
+    const char *b = base_name(path);
+    if (strncmp(b, "core", 4) == 0 && strstr(b, "trace")) return KIND_CORE_TRACE;
+    if (strncmp(b, "bustrace", 8) == 0) return KIND_BUS_TRACE;
+    if (strncmp(b, "memout", 6) == 0) return KIND_MEMOUT;
+    if (strncmp(b, "regout", 6) == 0) return KIND_REGOUT;
+    if (strncmp(b, "dsram", 5) == 0) return KIND_DSRAM;
+    if (strncmp(b, "tsram", 5) == 0) return KIND_TSRAM;
+    if (strncmp(b, "stats", 5) == 0) return KIND_STATS;
+    return KIND_TEXT;
+}
+
+// Memory images: one hex word per line, missing trailing lines read as zero
+static bool is_image(FileKind kind) {
+    return kind == KIND_MEMOUT || kind == KIND_REGOUT || kind == KIND_DSRAM || kind == KIND_TSRAM;
+}
+
+static const char *column_name(FileKind kind, int col) {
+    static const char *unnamed = "field";
+    if (is_image(kind)) return "value";
+    if (kind == KIND_CORE_TRACE && col < (int)(sizeof(CORE_TRACE_COLUMNS) / sizeof(CORE_TRACE_COLUMNS[0])))
+        return CORE_TRACE_COLUMNS[col];
+    if (kind == KIND_BUS_TRACE && col < (int)(sizeof(BUS_TRACE_COLUMNS) / sizeof(BUS_TRACE_COLUMNS[0])))
+        return BUS_TRACE_COLUMNS[col];
+    if (kind == KIND_STATS && col < 2) return STATS_COLUMNS[col];
+    return unnamed;
+}
+
+// ====================================================================================
+// COMPARISON
+// ====================================================================================
+
+typedef enum { RESULT_MATCH, RESULT_DIFF, RESULT_ERROR } CompareResult;
+
+typedef struct {
+    char gen_path[MAX_PATH_LEN];
+    char ref_path[MAX_PATH_LEN];
+    FileKind kind;
+
+    CompareResult result;
+    size_t line;            // 1-based line of the first divergence
+    int column;             // -1 = one file ended early
+    long long cycle;        // trace cycle of the divergence, -1 if not a trace
+    char gen_line[MAX_LINE_COPY];
+    char ref_line[MAX_LINE_COPY];
+    size_t gen_lines;
+    size_t ref_lines;
+    char error[MAX_PATH_LEN + 64];
+} CompareJob;
+
+static const char ZERO_WORD[] = "00000000";
+static const char END_MARK[] = "<end of file>";
+
+static void compare_files(CompareJob *job) {
+    MappedFile gen, ref;
+
+    job->result = RESULT_MATCH;
+    job->column = -1;
+    job->cycle = -1;
+    if (!map_file(job->gen_path, &gen)) {
+        snprintf(job->error, sizeof(job->error), "Could not open %s", job->gen_path);
+        job->result = RESULT_ERROR;
+        return;
+    }
+    if (!map_file(job->ref_path, &ref)) {
+        snprintf(job->error, sizeof(job->error), "Could not open %s", job->ref_path);
+        job->result = RESULT_ERROR;
+        unmap_file(&gen);
+        return;
+    }
+
+    // Fast path: byte-identical files
+    if (gen.size == ref.size && memcmp(gen.data, ref.data, gen.size) == 0) {
+        unmap_file(&gen);
+        unmap_file(&ref);
+        return;
+    }
+
+    LineReader rg, rr;
+    reader_init(&rg, &gen);
+    reader_init(&rr, &ref);
+    bool image = is_image(job->kind);
+
+    for (;;) {
+        const char *gs, *ge, *rs, *re;
+        bool have_g = next_line(&rg, &gs, &ge);
+        bool have_r = next_line(&rr, &rs, &re);
+        if (!have_g && !have_r) break;
+
+        if (!have_g || !have_r) {
+            if (!image) {
+                job->result = RESULT_DIFF;
+                job->line = have_g ? rg.line : rr.line;
+                if (!have_g) { gs = END_MARK; ge = END_MARK + sizeof(END_MARK) - 1; }
+                if (!have_r) { rs = END_MARK; re = END_MARK + sizeof(END_MARK) - 1; }
+                copy_line(job->gen_line, gs, ge);
+                copy_line(job->ref_line, rs, re);
+                break;
+            }
+            // Shorter image: compare the remaining lines against zero
+            if (!have_g) { gs = ZERO_WORD; ge = ZERO_WORD + 8; }
+            if (!have_r) { rs = ZERO_WORD; re = ZERO_WORD + 8; }
+        }
+
+        // Byte-equal lines need no field split
+        if ((ge - gs) == (re - rs) && memcmp(gs, rs, (size_t)(ge - gs)) == 0) continue;
+
+        Field fg[MAX_FIELDS], fr[MAX_FIELDS];
+        int ng = split_fields(gs, ge, fg, MAX_FIELDS);
+        int nr = split_fields(rs, re, fr, MAX_FIELDS);
+        int n = ng > nr ? ng : nr;
+        int col = -1;
+        for (int i = 0; i < n; i++) {
+            if (i >= ng || i >= nr) {
+                // Blank trailing image line counts as zero
+                if (image && ng == 0 && field_hex(&fr[0]) == 0) break;
+                if (image && nr == 0 && field_hex(&fg[0]) == 0) break;
+                col = i;
+                break;
+            }
+            bool same = image ? field_hex(&fg[i]) == field_hex(&fr[i]) : field_equal(&fg[i], &fr[i]);
+            if (!same) {
+                col = i;
+                break;
+            }
+        }
+        if (col < 0) continue;
+
+        job->result = RESULT_DIFF;
+        job->line = have_g ? rg.line : rr.line;
+        job->column = col;
+        copy_line(job->gen_line, gs, ge);
+        copy_line(job->ref_line, rs, re);
+        if ((job->kind == KIND_CORE_TRACE || job->kind == KIND_BUS_TRACE) && ng > 0 && nr > 0) {
+            long long cg = field_dec(&fg[0]);
+            long long cr = field_dec(&fr[0]);
+            job->cycle = cg < cr ? cg : cr;
+        }
+        break;
+    }
+
+    // Line totals for the report (continue counting past the divergence)
+    if (job->result == RESULT_DIFF) {
+        const char *s, *e;
+        while (next_line(&rg, &s, &e)) {}
+        while (next_line(&rr, &s, &e)) {}
+        job->gen_lines = rg.line;
+        job->ref_lines = rr.line;
+        if (job->cycle < 0 && (job->kind == KIND_CORE_TRACE || job->kind == KIND_BUS_TRACE)) {
+            Field f;
+            const char *line = strcmp(job->gen_line, END_MARK) != 0 ? job->gen_line : job->ref_line;
+            if (split_fields(line, line + strlen(line), &f, 1) > 0) job->cycle = field_dec(&f);
+        }
+    }
+
+    unmap_file(&gen);
+    unmap_file(&ref);
+}
+
+typedef struct {
+    CompareJob *jobs;
+    int count;
+    volatile long next;
+} JobQueue;
+
+static thread_ret_t THREAD_CALL compare_worker(void *arg) {
+    JobQueue *q = (JobQueue *)arg;
+    for (;;) {
+        long i = atomic_fetch_inc(&q->next);
+        if (i >= q->count) break;
+        compare_files(&q->jobs[i]);
+    }
+    return 0;
+}
+
+// ====================================================================================
+// DIVERGENCE CONTEXT
+// ====================================================================================
+
+static void sibling_path(const char *path, const char *name, char *out, size_t size) {
+    const char *b = base_name(path);
+    snprintf(out, size, "%.*s%s", (int)(b - path), path, name);
+}
+
+// Bus transactions within [from, to] cycles
+static void print_bus_window(const char *label, const char *path, long long from, long long to) {
+    MappedFile m;
+    printf("    %s bus (%s):\n", label, path);
+    if (!map_file(path, &m)) {
+        printf("      <unavailable>\n");
+        return;
+    }
+    LineReader r;
+    const char *s, *e;
+    int shown = 0;
+    reader_init(&r, &m);
+    while (next_line(&r, &s, &e)) {
+        Field f;
+        if (split_fields(s, e, &f, 1) == 0) continue;
+        long long c = field_dec(&f);
+        if (c > to) break;
+        if (c >= from) {
+            printf("      %.*s\n", (int)(e - s), s);
+            shown++;
+        }
+    }
+    if (!shown) printf("      <no transactions>\n");
+    unmap_file(&m);
+}
+
+// Fetch the core trace line of a given cycle (empty if the core was not running)
+static void find_trace_cycle(const char *path, long long cycle, char *line) {
+    MappedFile m;
+    line[0] = '\0';
+    if (!map_file(path, &m)) return;
+    LineReader r;
+    const char *s, *e;
+    reader_init(&r, &m);
+    while (next_line(&r, &s, &e)) {
+        Field f;
+        if (split_fields(s, e, &f, 1) == 0) continue;
+        long long c = field_dec(&f);
+        if (c > cycle) break;
+        if (c == cycle) {
+            copy_line(line, s, e);
+            break;
+        }
+    }
+    unmap_file(&m);
+}
+
+static void print_stage_pcs(const char *label, const char *line) {
+    Field f[MAX_FIELDS];
+    int n = split_fields(line, line + strlen(line), f, MAX_FIELDS);
+    printf("    %-10s", label);
+    if (n < 6) {
+        printf(" <no trace line at this cycle>\n");
+        return;
+    }
+    for (int i = 1; i <= 5; i++) printf(" %s=%.*s", CORE_TRACE_COLUMNS[i], f[i].len, f[i].s);
+    printf("\n");
+}
+
+static void print_register_diffs(const char *gen_line, const char *ref_line) {
+    Field fg[MAX_FIELDS], fr[MAX_FIELDS];
+    int ng = split_fields(gen_line, gen_line + strlen(gen_line), fg, MAX_FIELDS);
+    int nr = split_fields(ref_line, ref_line + strlen(ref_line), fr, MAX_FIELDS);
+    int diffs = 0;
+    printf("    register diffs:");
+    for (int i = 6; i < 20 && i < ng && i < nr; i++) {
+        if (!field_equal(&fg[i], &fr[i])) {
+            printf(" %s gen=%.*s ref=%.*s;", CORE_TRACE_COLUMNS[i], fg[i].len, fg[i].s, fr[i].len, fr[i].s);
+            diffs++;
+        }
+    }
+    printf("%s\n", diffs ? "" : " none");
+}
+
+static void print_divergence(const CompareJob *job, int context) {
+    const char *name = base_name(job->gen_path);
+
+    printf("\nDIFF %s: line %llu", name, (unsigned long long)job->line);
+    if (job->cycle >= 0) printf(", cycle %lld", job->cycle);
+    if (job->column >= 0) printf(", column %s", column_name(job->kind, job->column));
+    else printf(", length mismatch");
+    printf(" (%llu vs %llu lines)\n", (unsigned long long)job->gen_lines, (unsigned long long)job->ref_lines);
+    if (job->kind == KIND_DSRAM || job->kind == KIND_TSRAM || job->kind == KIND_MEMOUT) {
+        printf("    %s index %llu\n", job->kind == KIND_TSRAM ? "set" : "address",
+               (unsigned long long)(job->line - 1));
+    } else if (job->kind == KIND_REGOUT) {
+        printf("    register R%llu\n", (unsigned long long)(job->line + 1));
+    }
+    printf("    generated: %s\n", job->gen_line);
+    printf("    reference: %s\n", job->ref_line);
+
+    if (job->cycle < 0) return;
+
+    char gen_bus[MAX_PATH_LEN], ref_bus[MAX_PATH_LEN];
+    sibling_path(job->gen_path, "bustrace.txt", gen_bus, sizeof(gen_bus));
+    sibling_path(job->ref_path, "bustrace.txt", ref_bus, sizeof(ref_bus));
+
+    if (job->kind == KIND_CORE_TRACE) {
+        print_stage_pcs("generated", job->gen_line);
+        print_stage_pcs("reference", job->ref_line);
+        print_register_diffs(job->gen_line, job->ref_line);
+    } else {
+        // Bus divergence: where was every core at that cycle?
+        for (int c = 0; c < 4; c++) {
+            char trace_name[32], gen_trace[MAX_PATH_LEN], ref_trace[MAX_PATH_LEN];
+            char gen_line[MAX_LINE_COPY], ref_line[MAX_LINE_COPY];
+            sprintf(trace_name, "core%dtrace.txt", c);
+            sibling_path(job->gen_path, trace_name, gen_trace, sizeof(gen_trace));
+            sibling_path(job->ref_path, trace_name, ref_trace, sizeof(ref_trace));
+            find_trace_cycle(gen_trace, job->cycle, gen_line);
+            find_trace_cycle(ref_trace, job->cycle, ref_line);
+            printf("    core %d:\n", c);
+            print_stage_pcs("generated", gen_line);
+            print_stage_pcs("reference", ref_line);
+        }
+    }
+
+    printf("    bus transactions, cycles %lld..%lld:\n", job->cycle - context, job->cycle + context);
+    print_bus_window("generated", gen_bus, job->cycle - context, job->cycle + context);
+    print_bus_window("reference", ref_bus, job->cycle - context, job->cycle + context);
+}
+
+// ====================================================================================
+// MAIN
+// ====================================================================================
+
+static const char *OUTPUT_FILES[] = {
+    "memout.txt",
+    "regout0.txt", "regout1.txt", "regout2.txt", "regout3.txt",
+    "core0trace.txt", "core1trace.txt", "core2trace.txt", "core3trace.txt",
+    "bustrace.txt",
+    "dsram0.txt", "dsram1.txt", "dsram2.txt", "dsram3.txt",
+    "tsram0.txt", "tsram1.txt", "tsram2.txt", "tsram3.txt",
+    "stats0.txt", "stats1.txt", "stats2.txt", "stats3.txt"
+};
+#define NUM_OUTPUT_FILES ((int)(sizeof(OUTPUT_FILES) / sizeof(OUTPUT_FILES[0])))
+
+static bool is_directory(const char *path) {
+#ifdef _WIN32
+    DWORD attr = GetFileAttributesA(path);
+    return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] <generated_dir> <reference_dir>\n", prog);
+    fprintf(stderr, "   OR: %s [options] <generated_file> <reference_file>\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --jobs N       Worker threads (default: one per file, max %d)\n", MAX_JOBS);
+    fprintf(stderr, "  --context N    Bus cycles shown either side of a divergence (default %d)\n", DEFAULT_CONTEXT);
+    fprintf(stderr, "  --quiet        Only print differences\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *paths[2];
+    int npaths = 0;
+    int jobs_wanted = 0;
+    int context = DEFAULT_CONTEXT;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs_wanted = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--context") == 0 && i + 1 < argc) {
+            context = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strncmp(argv[i], "--", 2) != 0 && npaths < 2) {
+            paths[npaths++] = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (npaths != 2) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    CompareJob *jobs = (CompareJob *)calloc(NUM_OUTPUT_FILES, sizeof(CompareJob));
+    if (!jobs) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 2;
+    }
+
+    int count = 0;
+    if (is_directory(paths[0])) {
+        for (int i = 0; i < NUM_OUTPUT_FILES; i++) {
+            snprintf(jobs[i].gen_path, MAX_PATH_LEN, "%s/%s", paths[0], OUTPUT_FILES[i]);
+            snprintf(jobs[i].ref_path, MAX_PATH_LEN, "%s/%s", paths[1], OUTPUT_FILES[i]);
+            jobs[i].kind = detect_kind(OUTPUT_FILES[i]);
+        }
+        count = NUM_OUTPUT_FILES;
+    } else {
+        snprintf(jobs[0].gen_path, MAX_PATH_LEN, "%s", paths[0]);
+        snprintf(jobs[0].ref_path, MAX_PATH_LEN, "%s", paths[1]);
+        jobs[0].kind = detect_kind(paths[1]);
+        count = 1;
+    }
+
+    int workers = jobs_wanted > 0 ? jobs_wanted : count;
+    if (workers > count) workers = count;
+    if (workers > MAX_JOBS) workers = MAX_JOBS;
+
+    JobQueue queue = { jobs, count, 0 };
+    thread_t threads[MAX_JOBS];
+    int started = 0;
+    for (int i = 1; i < workers; i++) {
+        if (thread_start(&threads[started], compare_worker, &queue)) started++;
+    }
+    compare_worker(&queue);
+    for (int i = 0; i < started; i++) thread_join(threads[i]);
+
+    // Report in fixed file order
+    int diffs = 0, errors = 0;
+    const CompareJob *earliest = NULL;
+    for (int i = 0; i < count; i++) {
+        const CompareJob *job = &jobs[i];
+        const char *name = base_name(job->gen_path);
+        if (job->result == RESULT_ERROR) {
+            fprintf(stderr, "Error: %s\n", job->error);
+            errors++;
+        } else if (job->result == RESULT_DIFF) {
+            printf("DIFF:    %s\n", name);
+            diffs++;
+            if (job->cycle >= 0 && (!earliest || job->cycle < earliest->cycle)) earliest = job;
+        } else if (!quiet) {
+            printf("MATCH:   %s\n", name);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].result == RESULT_DIFF) print_divergence(&jobs[i], context);
+    }
+
+    if (earliest) {
+        printf("\nFirst divergence: %s at cycle %lld\n", base_name(earliest->gen_path), earliest->cycle);
+    }
+    printf("%d of %d files match%s\n", count - diffs - errors, count, errors ? " (with errors)" : "");
+
+    free(jobs);
+    if (errors) return 2;
+    return diffs ? 1 : 0;
+}
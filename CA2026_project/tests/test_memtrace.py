@@ -0,0 +1,102 @@
+import os
+import shutil
+import subprocess
+import sys
+
+# Record/replay test for --record-mem / --replay-mem (run by make test).
+# Usage: python test_memtrace.py <sim> [workload_dir ...]
+# Runs each workload once recording its memory-reference trace and once
+# replaying it, then requires the memory-system outputs to be identical:
+# memout, bustrace, busqueue, every DSRAM/TSRAM and the cache statistics.
+# Defaults to the example and every workload under inputs/.
+
+PROJECT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+COMPARED_FILES = (['memout.txt', 'bustrace.txt', 'busqueue.txt'] +
+                  [f'dsram{i}.txt' for i in range(4)] + [f'tsram{i}.txt' for i in range(4)])
+COMPARED_STATS = ['cycles', 'read_hit', 'write_hit', 'read_miss', 'write_miss', 'mem_stall']
+
+def default_workloads():
+    dirs = [os.path.join(PROJECT, 'examples', 'example_061225_win')]
+    inputs = os.path.join(PROJECT, 'inputs')
+    for root, _, files in sorted(os.walk(inputs)):
+        if 'imem0.txt' in files and 'memin.txt' in files:
+            dirs.append(root)
+    return dirs
+
+def run(sim, workload, out_dir, mode_args):
+    if os.path.exists(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(os.path.join(out_dir, 'outputs'))    # Where the simulator writes its .asm listings
+    out = lambda name: os.path.join(out_dir, name)
+    args = [sim] + mode_args
+    args += [os.path.join(workload, f'imem{i}.txt') for i in range(4)]
+    args += [os.path.join(workload, 'memin.txt'), out('memout.txt')]
+    args += [out(f'regout{i}.txt') for i in range(4)]
+    args += [out(f'core{i}trace.txt') for i in range(4)]
+    args += [out('bustrace.txt')]
+    args += [out(f'dsram{i}.txt') for i in range(4)]
+    args += [out(f'tsram{i}.txt') for i in range(4)]
+    args += [out(f'stats{i}.txt') for i in range(4)]
+    result = subprocess.run(args, cwd=out_dir, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    if result.returncode != 0:
+        print(result.stderr.strip())
+    return result.returncode == 0
+
+def read_stats(filename):
+    stats = {}
+    with open(filename, 'r') as f:
+        for line in f:
+            parts = line.split()
+            if len(parts) == 2:
+                stats[parts[0]] = parts[1]
+    return stats
+
+def read_file(filename):
+    with open(filename, 'r') as f:
+        return f.read()
+
+def compare(record_dir, replay_dir):
+    diffs = []
+    for name in COMPARED_FILES:
+        if read_file(os.path.join(record_dir, name)) != read_file(os.path.join(replay_dir, name)):
+            diffs.append(name)
+    for i in range(4):
+        recorded = read_stats(os.path.join(record_dir, f'stats{i}.txt'))
+        replayed = read_stats(os.path.join(replay_dir, f'stats{i}.txt'))
+        for key in COMPARED_STATS:
+            if recorded.get(key) != replayed.get(key):
+                diffs.append(f'stats{i}:{key} ({recorded.get(key)} vs {replayed.get(key)})')
+    return diffs
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: python test_memtrace.py <sim> [workload_dir ...]")
+        return 2
+    sim = os.path.abspath(sys.argv[1])
+    workloads = [os.path.abspath(w) for w in sys.argv[2:]] or default_workloads()
+    tmp = os.path.join(os.path.dirname(sim), 'test_memtrace')
+
+    failures = 0
+    for workload in workloads:
+        name = os.path.relpath(workload, PROJECT)
+        trace = os.path.join(tmp, 'memtrace.txt')
+        record_dir, replay_dir = os.path.join(tmp, 'record'), os.path.join(tmp, 'replay')
+        os.makedirs(tmp, exist_ok=True)
+        if not run(sim, workload, record_dir, ['--record-mem', trace]) or \
+           not run(sim, workload, replay_dir, ['--replay-mem', trace]):
+            print(f"{name:<40} FAIL (run)")
+            failures += 1
+            continue
+        diffs = compare(record_dir, replay_dir)
+        if diffs:
+            print(f"{name:<40} FAIL: {', '.join(diffs)}")
+            failures += 1
+        else:
+            print(f"{name:<40} ok")
+
+    shutil.rmtree(tmp, ignore_errors=True)
+    print(f"test_memtrace: {len(workloads) - failures}/{len(workloads)} workloads replay identically")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,95 @@
+// Disable MSVC security warnings for standard C functions
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simlib.h"
+
+// ====================================================================================
+// EMBEDDABLE API TEST (make test)
+// Drives one small program through simlib_create, step, run_until, the
+// register/memory reads, reset and destroy, and checks that a reset
+// simulator reruns it to the same result in the same number of cycles.
+// ====================================================================================
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// Core 0: r2 = mem[0x40]; r3 = r2 + 3; mem[0x64] = r3; halt. Cores 1-3 halt.
+static const uint32_t PROGRAM[] = {
+    0x10201040,     // lw  r2, r0, r1, 0x40
+    0x00321003,     // add r3, r2, r1, 3
+    0x11301064,     // sw  r3, r0, r1, 0x64
+    0x14000000      // halt
+};
+static const uint32_t HALT = 0x14000000;
+static const uint32_t INPUT = 7;
+
+static void load_workload(Simulator *sim) {
+    CHECK(simlib_load_program(sim, 0, PROGRAM, sizeof(PROGRAM) / sizeof(PROGRAM[0])));
+    for (int i = 1; i < NUM_CORES; i++) CHECK(simlib_load_program(sim, i, &HALT, 1));
+    CHECK(simlib_load_memory(sim, 0x40, &INPUT, 1));
+}
+
+static bool loaded(Simulator *sim, void *user) {
+    (void)user;
+    return simlib_register(sim, 0, 2) == INPUT;
+}
+
+int main(void) {
+    Simulator *sim = simlib_create(NULL);
+    if (!sim) {
+        fprintf(stderr, "FAIL simlib_create returned NULL\n");
+        return 1;
+    }
+    CHECK(!simlib_load_program(sim, NUM_CORES, &HALT, 1));
+    load_workload(sim);
+
+    // Single steps, then the rest of the run
+    CHECK(simlib_step(sim, 1) == SIM_STOP_CYCLES);
+    CHECK(simlib_cycle(sim) == 1);
+    CHECK(!simlib_done(sim));
+    CHECK(simlib_run_until(sim, NULL, NULL, 100000) == SIM_STOP_DONE);
+    CHECK(simlib_done(sim));
+    uint64_t cycles = simlib_cycle(sim);
+    for (int i = 0; i < NUM_CORES; i++) CHECK(simlib_halted(sim, i));
+    CHECK(simlib_register(sim, 0, 2) == INPUT);
+    CHECK(simlib_register(sim, 0, 3) == INPUT + 3);
+    CHECK(simlib_read_coherent(sim, 0x64) == INPUT + 3);
+    CHECK(simlib_read_memory(sim, 0x40) == INPUT);
+
+    SimCacheLine line;
+    CHECK(simlib_cache_line(sim, 0, (0x64 >> 3) & 0x3F, &line));
+    CHECK(line.state == MESI_MODIFIED && line.addr == 0x60 && line.data[4] == INPUT + 3);
+
+    // A reset returns to the power-on state
+    CHECK(simlib_reset(sim));
+    CHECK(simlib_cycle(sim) == 0);
+    CHECK(simlib_register(sim, 0, 3) == 0);
+    CHECK(simlib_read_coherent(sim, 0x64) == 0);
+
+    // The same run again, stopped by a predicate on the way
+    load_workload(sim);
+    CHECK(simlib_run_until(sim, loaded, NULL, 100000) == SIM_STOP_PREDICATE);
+    CHECK(simlib_register(sim, 0, 2) == INPUT);
+    CHECK(!simlib_done(sim));
+    CHECK(simlib_run_until(sim, NULL, NULL, 100000) == SIM_STOP_DONE);
+    CHECK(simlib_cycle(sim) == cycles);
+    CHECK(simlib_read_coherent(sim, 0x64) == INPUT + 3);
+
+    simlib_destroy(sim);
+
+    if (failures) {
+        fprintf(stderr, "test_simlib: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_simlib: OK (%llu cycles)\n", (unsigned long long)cycles);
+    return 0;
+}
@@ -0,0 +1,83 @@
+import os
+import shutil
+import subprocess
+import sys
+
+# Warm-start test for --warm-start with --cosim and --functional (run by make test).
+# Usage: python test_warm_start.py <sim> [workload_dir ...]
+# Runs each workload once to save its end state, then starts it again from
+# that state (caches holding Modified lines newer than memory). The --cosim
+# run must find no mismatch, and --functional must compute the same
+# registers as the timing run. Defaults to bench/false_sharing and
+# bench/lock_contention, which reload the data their Modified lines hold.
+
+PROJECT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_WORKLOADS = ['false_sharing', 'lock_contention']
+
+def run(sim, workload, out_dir, extra_args):
+    if os.path.exists(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(os.path.join(out_dir, 'outputs'))    # Where the simulator writes its .asm listings
+    out = lambda name: os.path.join(out_dir, name)
+    args = [sim] + extra_args
+    args += [os.path.join(workload, f'imem{i}.txt') for i in range(4)]
+    args += [os.path.join(workload, 'memin.txt'), out('memout.txt')]
+    args += [out(f'regout{i}.txt') for i in range(4)]
+    args += [out(f'core{i}trace.txt') for i in range(4)]
+    args += [out('bustrace.txt')]
+    args += [out(f'dsram{i}.txt') for i in range(4)]
+    args += [out(f'tsram{i}.txt') for i in range(4)]
+    args += [out(f'stats{i}.txt') for i in range(4)]
+    result = subprocess.run(args, cwd=out_dir, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    if result.returncode != 0:
+        print(result.stderr.strip())
+    return result.returncode == 0
+
+def read_file(filename):
+    with open(filename, 'r') as f:
+        return f.read()
+
+def check(sim, workload, tmp):
+    saved, timing = os.path.join(tmp, 'saved'), os.path.join(tmp, 'timing')
+    cosim, functional = os.path.join(tmp, 'cosim'), os.path.join(tmp, 'functional')
+    if not run(sim, workload, saved, []):
+        return ['cold run failed']
+    if not run(sim, workload, timing, ['--warm-start', saved]):
+        return ['warm-started run failed']
+    problems = []
+    if not run(sim, workload, cosim, ['--warm-start', saved, '--cosim']):
+        problems.append('--cosim mismatch')
+    if not run(sim, workload, functional, ['--warm-start', saved, '--functional']):
+        problems.append('--functional run failed')
+    else:
+        for i in range(4):
+            name = f'regout{i}.txt'
+            if read_file(os.path.join(timing, name)) != read_file(os.path.join(functional, name)):
+                problems.append(f'--functional {name}')
+    return problems
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: python test_warm_start.py <sim> [workload_dir ...]")
+        return 2
+    sim = os.path.abspath(sys.argv[1])
+    workloads = [os.path.abspath(w) for w in sys.argv[2:]] or \
+                [os.path.join(PROJECT, 'inputs', 'bench', w) for w in DEFAULT_WORKLOADS]
+    tmp = os.path.join(os.path.dirname(sim), 'test_warm_start')
+
+    failures = 0
+    for workload in workloads:
+        name = os.path.relpath(workload, PROJECT)
+        problems = check(sim, workload, tmp)
+        if problems:
+            print(f"{name:<40} FAIL: {', '.join(problems)}")
+            failures += 1
+        else:
+            print(f"{name:<40} ok")
+
+    shutil.rmtree(tmp, ignore_errors=True)
+    print(f"test_warm_start: {len(workloads) - failures}/{len(workloads)} warm-started workloads agree")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())